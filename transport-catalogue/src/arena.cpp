@@ -0,0 +1,41 @@
+#include "arena.h"
+
+namespace trc {
+
+CountingResource::CountingResource(std::pmr::memory_resource* upstream)
+    : upstream_(upstream) {}
+
+size_t CountingResource::GetAllocationCount() const {
+    return allocation_count_;
+}
+
+size_t CountingResource::GetAllocatedBytes() const { return allocated_bytes_; }
+
+void* CountingResource::do_allocate(size_t bytes, size_t alignment) {
+    ++allocation_count_;
+    allocated_bytes_ += bytes;
+    return upstream_->allocate(bytes, alignment);
+}
+
+void CountingResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    upstream_->deallocate(p, bytes, alignment);
+}
+
+bool CountingResource::do_is_equal(
+    const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+Arena::Arena()
+    : blocks_(std::pmr::new_delete_resource()),
+      buffer_(&blocks_),
+      requests_(&buffer_) {}
+
+std::pmr::memory_resource* Arena::GetResource() { return &requests_; }
+
+Arena::Stats Arena::GetStats() const {
+    return {requests_.GetAllocationCount(), requests_.GetAllocatedBytes(),
+            blocks_.GetAllocationCount(), blocks_.GetAllocatedBytes()};
+}
+
+}  // namespace trc
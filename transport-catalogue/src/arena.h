@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace trc {
+
+// Memory resource that counts the requests passing through it.
+class CountingResource : public std::pmr::memory_resource {
+   public:
+    explicit CountingResource(std::pmr::memory_resource* upstream);
+
+    size_t GetAllocationCount() const;
+
+    size_t GetAllocatedBytes() const;
+
+   private:
+    std::pmr::memory_resource* upstream_;
+    size_t allocation_count_ = 0;
+    size_t allocated_bytes_ = 0;
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override;
+};
+
+// Monotonic arena: allocations are carved out of large blocks and released
+// all at once when the arena is destroyed. Not thread-safe; it is meant to
+// be filled while a catalogue is built and only read afterwards.
+class Arena {
+   public:
+    struct Stats {
+        // Requests served by the arena, i.e. what would otherwise be
+        // separate heap allocations.
+        size_t allocation_count;
+        size_t allocated_bytes;
+        // Blocks the arena itself took from the heap.
+        size_t block_count;
+        size_t block_bytes;
+    };
+
+    Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    std::pmr::memory_resource* GetResource();
+
+    Stats GetStats() const;
+
+   private:
+    CountingResource blocks_;
+    std::pmr::monotonic_buffer_resource buffer_;
+    CountingResource requests_;
+};
+
+}  // namespace trc
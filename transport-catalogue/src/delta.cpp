@@ -0,0 +1,130 @@
+#include "delta.h"
+
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace trc {
+
+using namespace std;
+
+namespace {
+
+void RequireStop(const TransportCatalogue& catalogue, const string& name) {
+    if (!catalogue.FindStopId(name)) {
+        throw invalid_argument("Unknown stop: " + name);
+    }
+}
+
+void AddBus(TransportCatalogue& catalogue, const NetworkDelta::BusUpdate& bus) {
+    for (const auto& stop : bus.stops) {
+        RequireStop(catalogue, stop);
+    }
+
+    catalogue.AddBus(bus.name, bus.stops, bus.is_roundtrip);
+}
+
+}  // namespace
+
+TransportCatalogue ApplyDelta(const TransportCatalogue& base,
+                              const NetworkDelta& delta) {
+    unordered_set<string_view> removed_stops;
+    for (const auto& name : delta.removed_stops) {
+        RequireStop(base, name);
+        removed_stops.insert(name);
+    }
+
+    unordered_set<string_view> removed_buses;
+    for (const auto& name : delta.removed_buses) {
+        if (!base.FindBusId(name)) {
+            throw invalid_argument("Unknown bus: " + name);
+        }
+        removed_buses.insert(name);
+    }
+
+    // When a delta lists a bus twice, the later route wins.
+    unordered_map<string_view, const NetworkDelta::BusUpdate*> bus_updates;
+    for (const auto& bus : delta.buses) {
+        bus_updates[bus.name] = &bus;
+    }
+
+    const auto& base_stops = base.GetStops();
+    const auto& base_buses = base.GetBuses();
+
+    size_t route_stop_count = 0;
+    for (const Bus& bus : base_buses) {
+        route_stop_count += bus.route_size;
+    }
+    for (const auto& bus : delta.buses) {
+        route_stop_count += bus.stops.size();
+    }
+
+    TransportCatalogue result;
+    result.Reserve(base_stops.size() + delta.stops.size(),
+                   base_buses.size() + delta.buses.size(), route_stop_count);
+
+    for (const Stop& stop : base_stops) {
+        if (!removed_stops.count(stop.name)) {
+            result.AddStop(Stop{stop});
+        }
+    }
+
+    // Re-adding a known name only moves the stop.
+    for (const auto& stop : delta.stops) {
+        result.AddStop(Stop{0, stop.name, stop.coordinates});
+    }
+
+    base.GetDistances().ForEach(
+        [&](StopId from, StopId to, double distance) {
+            const string_view from_name = base_stops[from].name;
+            const string_view to_name = base_stops[to].name;
+
+            if (!removed_stops.count(from_name) &&
+                !removed_stops.count(to_name)) {
+                result.AddDistance(from_name, to_name, distance);
+            }
+        });
+
+    for (const auto& [from, to, distance] : delta.distances) {
+        RequireStop(result, from);
+        RequireStop(result, to);
+        result.AddDistance(from, to, distance);
+    }
+
+    for (const Bus& bus : base_buses) {
+        if (removed_buses.count(bus.name)) {
+            continue;
+        }
+
+        if (const auto it = bus_updates.find(bus.name);
+            it != bus_updates.end()) {
+            AddBus(result, *it->second);
+            continue;
+        }
+
+        vector<string> stops;
+        stops.reserve(bus.route_size);
+
+        for (const Stop* stop : base.GetListedStops(bus)) {
+            if (removed_stops.count(stop->name)) {
+                throw invalid_argument("Bus " + string(bus.name) +
+                                       " stops at removed stop " +
+                                       string(stop->name));
+            }
+            stops.emplace_back(stop->name);
+        }
+
+        result.AddBus(bus.name, stops, bus.is_roundtrip);
+    }
+
+    for (const auto& bus : delta.buses) {
+        if (!result.FindBusId(bus.name)) {
+            AddBus(result, *bus_updates.at(bus.name));
+        }
+    }
+
+    return result;
+}
+
+}  // namespace trc
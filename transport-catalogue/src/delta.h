@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "geo.h"
+#include "transport_catalogue.h"
+
+namespace trc {
+
+// Edits to a network, keyed by names so that they do not depend on the ids
+// a particular catalogue gave out.
+struct NetworkDelta {
+    struct StopUpdate {
+        std::string name;
+        geo::Coordinates coordinates;
+    };
+
+    struct DistanceUpdate {
+        std::string from;
+        std::string to;
+        double distance;
+    };
+
+    struct BusUpdate {
+        std::string name;
+        std::vector<std::string> stops;
+        bool is_roundtrip;
+    };
+
+    std::vector<std::string> removed_stops;
+    std::vector<std::string> removed_buses;
+    // Added stops, or new coordinates of existing ones.
+    std::vector<StopUpdate> stops;
+    std::vector<DistanceUpdate> distances;
+    // Added buses, or new routes of existing ones.
+    std::vector<BusUpdate> buses;
+};
+
+// Builds the catalogue that results from applying delta to base. Surviving
+// stops and buses keep their relative order, so unchanged entities keep
+// their ids when nothing is removed. Bus statistics are recomputed since
+// any distance may have changed. Throws std::invalid_argument when the
+// delta refers to an unknown stop or bus, or a bus would be left with a
+// removed stop.
+TransportCatalogue ApplyDelta(const TransportCatalogue& base,
+                              const NetworkDelta& delta);
+
+}  // namespace trc
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "graph.h"
+
+namespace graph {
+
+// Single-source shortest paths computed on demand. Unlike Router it needs no
+// precompute, so it is used where a query may exclude parts of the graph or
+// has to stay within a bounded amount of work.
+template <typename Weight>
+class Dijkstra {
+   private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+   public:
+    struct RouteInfo {
+        Weight weight;
+        std::vector<EdgeId> edges;
+    };
+
+    explicit Dijkstra(const Graph& graph);
+
+    void BanVertex(VertexId vertex);
+    void BanEdge(EdgeId edge);
+    void ClearBans();
+
+    // Maximum number of vertices settled over the lifetime of the object.
+    // Once it is reached every search stops and reports no route.
+    void SetExpansionLimit(size_t limit);
+    size_t GetExpandedVertexCount() const;
+    bool IsLimitReached() const;
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to);
+
+    // Calls visitor(vertex, weight) for every vertex whose distance from
+    // `from` does not exceed max_weight, in order of increasing distance.
+    template <typename Visitor>
+    void VisitReachable(VertexId from, Weight max_weight, Visitor visitor);
+
+   private:
+    using QueueItem = std::pair<Weight, VertexId>;
+
+    struct QueueItemGreater {
+        bool operator()(const QueueItem& lhs, const QueueItem& rhs) const {
+            return rhs.first < lhs.first;
+        }
+    };
+
+    using Queue =
+        std::priority_queue<QueueItem, std::vector<QueueItem>, QueueItemGreater>;
+
+    const Graph& graph_;
+    std::vector<bool> banned_vertices_;
+    std::vector<bool> banned_edges_;
+    std::vector<std::optional<Weight>> weights_;
+    std::vector<std::optional<EdgeId>> prev_edges_;
+    std::vector<bool> settled_;
+    std::vector<VertexId> touched_;
+    size_t expansion_limit_ = std::numeric_limits<size_t>::max();
+    size_t expanded_vertex_count_ = 0;
+    bool limit_reached_ = false;
+
+    void Reset();
+
+    void Start(VertexId from, Queue& queue);
+
+    // Settles the closest vertex from the queue, returns nullopt when the
+    // queue is exhausted or the expansion limit is hit.
+    std::optional<VertexId> SettleNext(Queue& queue);
+};
+
+template <typename Weight>
+Dijkstra<Weight>::Dijkstra(const Graph& graph)
+    : graph_(graph),
+      banned_vertices_(graph.GetVertexCount()),
+      banned_edges_(graph.GetEdgeCount()),
+      weights_(graph.GetVertexCount()),
+      prev_edges_(graph.GetVertexCount()),
+      settled_(graph.GetVertexCount()) {}
+
+template <typename Weight>
+void Dijkstra<Weight>::BanVertex(VertexId vertex) {
+    banned_vertices_.at(vertex) = true;
+}
+
+template <typename Weight>
+void Dijkstra<Weight>::BanEdge(EdgeId edge) {
+    banned_edges_.at(edge) = true;
+}
+
+template <typename Weight>
+void Dijkstra<Weight>::ClearBans() {
+    std::fill(banned_vertices_.begin(), banned_vertices_.end(), false);
+    std::fill(banned_edges_.begin(), banned_edges_.end(), false);
+}
+
+template <typename Weight>
+void Dijkstra<Weight>::SetExpansionLimit(size_t limit) {
+    expansion_limit_ = limit;
+}
+
+template <typename Weight>
+size_t Dijkstra<Weight>::GetExpandedVertexCount() const {
+    return expanded_vertex_count_;
+}
+
+template <typename Weight>
+bool Dijkstra<Weight>::IsLimitReached() const {
+    return limit_reached_;
+}
+
+template <typename Weight>
+std::optional<typename Dijkstra<Weight>::RouteInfo> Dijkstra<Weight>::BuildRoute(
+    VertexId from, VertexId to) {
+    Queue queue;
+    Start(from, queue);
+
+    std::optional<VertexId> vertex = SettleNext(queue);
+    while (vertex && *vertex != to) {
+        vertex = SettleNext(queue);
+    }
+
+    if (!vertex) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (std::optional<EdgeId> edge_id = prev_edges_[to]; edge_id;
+         edge_id = prev_edges_[graph_.GetEdge(*edge_id).from]) {
+        edges.push_back(*edge_id);
+    }
+
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{*weights_[to], std::move(edges)};
+}
+
+template <typename Weight>
+template <typename Visitor>
+void Dijkstra<Weight>::VisitReachable(VertexId from, Weight max_weight,
+                                      Visitor visitor) {
+    Queue queue;
+    Start(from, queue);
+
+    while (true) {
+        // A stale entry of a settled vertex must not let the bound check
+        // pass for the entry behind it.
+        while (!queue.empty() && settled_[queue.top().second]) {
+            queue.pop();
+        }
+        if (queue.empty() || max_weight < queue.top().first) {
+            break;
+        }
+
+        if (std::optional<VertexId> vertex = SettleNext(queue)) {
+            visitor(*vertex, *weights_[*vertex]);
+        } else {
+            break;
+        }
+    }
+}
+
+template <typename Weight>
+void Dijkstra<Weight>::Reset() {
+    for (VertexId vertex : touched_) {
+        weights_[vertex].reset();
+        prev_edges_[vertex].reset();
+        settled_[vertex] = false;
+    }
+
+    touched_.clear();
+}
+
+template <typename Weight>
+void Dijkstra<Weight>::Start(VertexId from, Queue& queue) {
+    Reset();
+
+    if (banned_vertices_.at(from)) {
+        return;
+    }
+
+    weights_[from] = Weight{};
+    touched_.push_back(from);
+    queue.push({Weight{}, from});
+}
+
+template <typename Weight>
+std::optional<VertexId> Dijkstra<Weight>::SettleNext(Queue& queue) {
+    while (!queue.empty()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+
+        if (settled_[vertex]) {
+            continue;
+        }
+
+        if (expanded_vertex_count_ >= expansion_limit_) {
+            limit_reached_ = true;
+            return std::nullopt;
+        }
+
+        settled_[vertex] = true;
+        ++expanded_vertex_count_;
+
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+
+            if (banned_edges_[edge_id] || banned_vertices_[edge.to] ||
+                settled_[edge.to]) {
+                continue;
+            }
+
+            const Weight candidate = weight + edge.weight;
+            auto& to_weight = weights_[edge.to];
+
+            if (!to_weight || candidate < *to_weight) {
+                if (!to_weight) {
+                    touched_.push_back(edge.to);
+                }
+                to_weight = candidate;
+                prev_edges_[edge.to] = edge_id;
+                queue.push({candidate, edge.to});
+            }
+        }
+
+        return vertex;
+    }
+
+    return std::nullopt;
+}
+
+}  // namespace graph
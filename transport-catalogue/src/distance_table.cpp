@@ -0,0 +1,113 @@
+#include "distance_table.h"
+
+namespace trc {
+
+void DistanceTable::Set(StopId from, StopId to, double distance) {
+    if (2 * (size_ + 1) > slots_.size()) {
+        Grow();
+    }
+
+    const uint64_t key = Pack(from, to);
+    Slot& slot = slots_[Probe(key)];
+
+    if (slot.key == EMPTY_KEY) {
+        slot.key = key;
+        ++size_;
+    }
+
+    slot.distance = distance;
+}
+
+std::optional<double> DistanceTable::Find(StopId from, StopId to) const {
+    if (slots_.empty()) {
+        return std::nullopt;
+    }
+
+    const Slot& slot = slots_[Probe(Pack(from, to))];
+
+    if (slot.key == EMPTY_KEY) {
+        return std::nullopt;
+    }
+
+    return slot.distance;
+}
+
+size_t DistanceTable::GetSize() const { return size_; }
+
+memory::MemoryUsage DistanceTable::GetMemoryUsage() const {
+    memory::MemoryUsage usage;
+    usage.Add("slots", memory::GetCapacityBytes(slots_));
+    return usage;
+}
+
+uint64_t DistanceTable::Pack(StopId from, StopId to) {
+    return static_cast<uint64_t>(from) << 32 | to;
+}
+
+uint64_t DistanceTable::Mix(uint64_t key) {
+    // splitmix64 finalizer: every input bit affects every output bit, so
+    // dense ids spread evenly over the table.
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+}
+
+size_t DistanceTable::Probe(uint64_t key) const {
+    const size_t mask = slots_.size() - 1;
+
+    for (size_t index = Mix(key) & mask;; index = (index + 1) & mask) {
+        if (slots_[index].key == key || slots_[index].key == EMPTY_KEY) {
+            return index;
+        }
+    }
+}
+
+void DistanceTable::Reserve(size_t count) {
+    const size_t capacity = GetCapacityFor(count);
+
+    if (capacity > slots_.size()) {
+        Rehash(capacity);
+    }
+}
+
+void DistanceTable::ShrinkToFit() {
+    if (size_ == 0) {
+        slots_ = {};
+        return;
+    }
+
+    const size_t capacity = GetCapacityFor(size_);
+
+    if (capacity < slots_.size()) {
+        Rehash(capacity);
+    }
+}
+
+size_t DistanceTable::GetCapacityFor(size_t count) {
+    size_t capacity = MIN_CAPACITY;
+    while (capacity < 2 * count) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+void DistanceTable::Grow() {
+    Rehash(slots_.empty() ? MIN_CAPACITY : 2 * slots_.size());
+}
+
+void DistanceTable::Rehash(size_t capacity) {
+    std::vector<Slot> old_slots = std::move(slots_);
+
+    slots_.assign(capacity, Slot{EMPTY_KEY, 0.0});
+
+    for (const Slot& slot : old_slots) {
+        if (slot.key != EMPTY_KEY) {
+            slots_[Probe(slot.key)] = slot;
+        }
+    }
+}
+
+}  // namespace trc
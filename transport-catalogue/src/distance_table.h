@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "domain.h"
+#include "memory_usage.h"
+
+namespace trc {
+
+// Road distances between ordered pairs of stops. A single open addressing
+// table keyed by the packed (from, to) ids; the load factor is kept at or
+// below 1/2, so a lookup almost always inspects one slot.
+class DistanceTable {
+   public:
+    void Set(StopId from, StopId to, double distance);
+
+    std::optional<double> Find(StopId from, StopId to) const;
+
+    size_t GetSize() const;
+
+    memory::MemoryUsage GetMemoryUsage() const;
+
+    // Sizes the table for count distances, so that filling it rehashes once.
+    void Reserve(size_t count);
+
+    // Rehashes into the smallest table that keeps the load factor bound.
+    void ShrinkToFit();
+
+    // Calls action(from, to, distance) for every stored distance.
+    template <typename Action>
+    void ForEach(Action action) const;
+
+   private:
+    struct Slot {
+        uint64_t key;
+        double distance;
+    };
+
+    static constexpr uint64_t EMPTY_KEY = UINT64_MAX;
+    static constexpr size_t MIN_CAPACITY = 16;
+
+    std::vector<Slot> slots_;
+    size_t size_ = 0;
+
+    static uint64_t Pack(StopId from, StopId to);
+
+    static uint64_t Mix(uint64_t key);
+
+    // Slot holding key or the empty slot where it would be inserted.
+    size_t Probe(uint64_t key) const;
+
+    // Smallest power of two table keeping count entries within the bound.
+    static size_t GetCapacityFor(size_t count);
+
+    void Grow();
+
+    void Rehash(size_t capacity);
+};
+
+template <typename Action>
+void DistanceTable::ForEach(Action action) const {
+    for (const Slot& slot : slots_) {
+        if (slot.key != EMPTY_KEY) {
+            action(static_cast<StopId>(slot.key >> 32),
+                   static_cast<StopId>(slot.key), slot.distance);
+        }
+    }
+}
+
+}  // namespace trc
@@ -1,20 +1,60 @@
 #include "domain.h"
 
+#include <stdexcept>
+
 namespace trc {
 
-uint32_t Stop::ID = 0;
+bool operator<(const Bus& lhs, const Bus& rhs) { return lhs.name < rhs.name; }
+
+RouteView::RouteView(const Stop* stops, const StopId* stop_ids,
+                     size_t stored_size, bool is_mirrored)
+    : stops_(stops),
+      stop_ids_(stop_ids),
+      stored_size_(stored_size),
+      size_(is_mirrored && stored_size > 0 ? 2 * stored_size - 1
+                                           : stored_size) {}
+
+size_t RouteView::size() const { return size_; }
+
+bool RouteView::empty() const { return size_ == 0; }
 
-Stop::Stop(const std::string& name, geo::Coordinates coordinates)
-    : id(ID++), name(name), coordinates(coordinates) {}
+const Stop* RouteView::operator[](size_t index) const {
+    if (index >= stored_size_) {
+        index = size_ - 1 - index;
+    }
 
-size_t StopPairHasher::operator()(
-    const std::pair<const Stop*, const Stop*>& stop_pair) const {
-    const int prime_number = 47;
-    return reinterpret_cast<size_t>(stop_pair.first) +
-           prime_number * reinterpret_cast<size_t>(stop_pair.second);
+    return &stops_[stop_ids_[index]];
 }
 
-bool operator<(const Bus& lhs, const Bus& rhs) { return lhs.name < rhs.name; }
+const Stop* RouteView::at(size_t index) const {
+    if (index >= size_) {
+        throw std::out_of_range("Route index is out of range");
+    }
+
+    return (*this)[index];
+}
+
+RouteView::Iterator RouteView::begin() const { return {*this, 0}; }
+
+RouteView::Iterator RouteView::end() const { return {*this, size_}; }
+
+RouteView::Iterator::Iterator(RouteView route, size_t index)
+    : route_(route), index_(index) {}
+
+const Stop* RouteView::Iterator::operator*() const { return route_[index_]; }
+
+RouteView::Iterator& RouteView::Iterator::operator++() {
+    ++index_;
+    return *this;
+}
+
+bool RouteView::Iterator::operator==(const Iterator& other) const {
+    return index_ == other.index_;
+}
+
+bool RouteView::Iterator::operator!=(const Iterator& other) const {
+    return !(*this == other);
+}
 
 bool StopPtrCompare::operator()(const Stop* lhs, const Stop* rhs) const {
     return lhs->name < rhs->name;
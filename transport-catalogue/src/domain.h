@@ -1,43 +1,97 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
-#include <string>
+#include <iterator>
+#include <string_view>
 #include <vector>
 
 #include "geo.h"
 
 namespace trc {
 
-struct Stop {
-    Stop() = default;
-
-    Stop(const std::string& name, geo::Coordinates coordinates);
+using StopId = uint32_t;
+using BusId = uint32_t;
 
-    uint32_t id;
-    std::string name;
+// Names of stops and buses held by a catalogue point into its symbol tables.
+// Before AddStop/AddBus they only have to outlive the call.
+struct Stop {
+    // Assigned by the owning TransportCatalogue, dense from zero.
+    StopId id = 0;
+    std::string_view name;
     geo::Coordinates coordinates;
-
-   private:
-    static uint32_t ID;
 };
 
 struct Bus {
-    std::string name = {};
-    std::vector<const Stop*> route = {};
+    std::string_view name = {};
+    // Slice of the catalogue's shared array of route stop ids. Only the
+    // listed stops are stored, the return leg of a linear route is not.
+    uint32_t route_begin = 0;
+    uint32_t route_size = 0;
     double route_length = 0.0;
     double curvature = 0.0;
+    uint32_t unique_stop_count = 0;
     bool is_roundtrip = false;
 };
 
 bool operator<(const Bus& lhs, const Bus& rhs);
 
-struct StopPtrCompare {
-    bool operator()(const Stop* lhs, const Stop* rhs) const;
+// Stops of a bus route. Holds pointers into the catalogue storage, so it is
+// valid until the next stop or bus is added. A mirrored view walks the
+// stored stops there and back: A, B, C reads as A, B, C, B, A.
+class RouteView {
+   public:
+    class Iterator;
+
+    RouteView() = default;
+
+    RouteView(const Stop* stops, const StopId* stop_ids, size_t stored_size,
+              bool is_mirrored = false);
+
+    size_t size() const;
+
+    bool empty() const;
+
+    const Stop* operator[](size_t index) const;
+
+    const Stop* at(size_t index) const;
+
+    Iterator begin() const;
+
+    Iterator end() const;
+
+   private:
+    const Stop* stops_ = nullptr;
+    const StopId* stop_ids_ = nullptr;
+    size_t stored_size_ = 0;
+    size_t size_ = 0;
+};
+
+class RouteView::Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = const Stop*;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = value_type;
+
+    Iterator(RouteView route, size_t index);
+
+    const Stop* operator*() const;
+
+    Iterator& operator++();
+
+    bool operator==(const Iterator& other) const;
+
+    bool operator!=(const Iterator& other) const;
+
+   private:
+    RouteView route_;
+    size_t index_;
 };
 
-struct StopPairHasher {
-    size_t operator()(
-        const std::pair<const Stop*, const Stop*>& stop_pair) const;
+struct StopPtrCompare {
+    bool operator()(const Stop* lhs, const Stop* rhs) const;
 };
 
 }  // namespace trc
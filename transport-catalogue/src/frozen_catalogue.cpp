@@ -0,0 +1,53 @@
+#include "frozen_catalogue.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace trc {
+
+FrozenCatalogue::FrozenCatalogue(TransportCatalogue&& catalogue)
+    : catalogue_(std::move(catalogue)) {
+    catalogue_.ShrinkToFit();
+
+    stop_names_ = BuildStopNames();
+    bus_names_ = BuildBusNames();
+}
+
+const TransportCatalogue& FrozenCatalogue::Get() const { return catalogue_; }
+
+const PrefixIndex& FrozenCatalogue::GetStopNames() const { return stop_names_; }
+
+const PrefixIndex& FrozenCatalogue::GetBusNames() const { return bus_names_; }
+
+memory::MemoryUsage FrozenCatalogue::GetMemoryUsage() const {
+    memory::MemoryUsage usage = catalogue_.GetMemoryUsage();
+    usage.Add("stop_names", stop_names_.GetMemoryUsage());
+    usage.Add("bus_names", bus_names_.GetMemoryUsage());
+    return usage;
+}
+
+PrefixIndex FrozenCatalogue::BuildStopNames() const {
+    std::vector<PrefixIndex::Entry> entries;
+    entries.reserve(catalogue_.GetStops().size());
+
+    for (const Stop& stop : catalogue_.GetStops()) {
+        const auto buses = catalogue_.GetStopInfo(stop.name);
+        entries.push_back(
+            {stop.name, static_cast<uint32_t>(buses->end() - buses->begin())});
+    }
+
+    return PrefixIndex(std::move(entries));
+}
+
+PrefixIndex FrozenCatalogue::BuildBusNames() const {
+    std::vector<PrefixIndex::Entry> entries;
+    entries.reserve(catalogue_.GetBuses().size());
+
+    for (const Bus& bus : catalogue_.GetBuses()) {
+        entries.push_back({bus.name, bus.unique_stop_count});
+    }
+
+    return PrefixIndex(std::move(entries));
+}
+
+}  // namespace trc
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "prefix_index.h"
+#include "transport_catalogue.h"
+
+namespace trc {
+
+// Read-only snapshot of a fully built catalogue. It takes the catalogue
+// over, releases its spare capacity and from then on hands out only const
+// access. Const methods of TransportCatalogue neither modify nor cache
+// anything, so one snapshot can be queried from any number of threads
+// without locks, as long as it outlives them. Name prefix indexes, which a
+// growing catalogue could not keep sorted cheaply, are built here.
+class FrozenCatalogue {
+   public:
+    explicit FrozenCatalogue(TransportCatalogue&& catalogue);
+
+    FrozenCatalogue(const FrozenCatalogue&) = delete;
+    FrozenCatalogue& operator=(const FrozenCatalogue&) = delete;
+
+    const TransportCatalogue& Get() const;
+
+    // Stop names weighted by the number of buses serving the stop.
+    const PrefixIndex& GetStopNames() const;
+
+    // Bus names weighted by the number of distinct stops on the route.
+    const PrefixIndex& GetBusNames() const;
+
+    memory::MemoryUsage GetMemoryUsage() const;
+
+   private:
+    TransportCatalogue catalogue_;
+    PrefixIndex stop_names_;
+    PrefixIndex bus_names_;
+
+    PrefixIndex BuildStopNames() const;
+
+    PrefixIndex BuildBusNames() const;
+};
+
+}  // namespace trc
@@ -1,5 +1,7 @@
 #include "geo.h"
 
+#include <algorithm>
+
 namespace trc::geo {
 
 bool Coordinates::operator==(const Coordinates other) const {
@@ -10,4 +12,74 @@ bool Coordinates::operator!=(const Coordinates other) const {
     return !(*this == other);
 }
 
+namespace {
+
+// sin(x) for 0 <= x <= pi/2 from its Taylor series through x^19; the first
+// omitted term, (pi/2)^21 / 21! < 3e-16, bounds the error.
+double SinUpToHalfPi(double x) {
+    const double x2 = x * x;
+
+    double result = -1.0 / 121645100408832000.0;
+    result = result * x2 + 1.0 / 355687428096000.0;
+    result = result * x2 - 1.0 / 1307674368000.0;
+    result = result * x2 + 1.0 / 6227020800.0;
+    result = result * x2 - 1.0 / 39916800.0;
+    result = result * x2 + 1.0 / 362880.0;
+    result = result * x2 - 1.0 / 5040.0;
+    result = result * x2 + 1.0 / 120.0;
+    result = result * x2 - 1.0 / 6.0;
+    result = result * x2 + 1.0;
+
+    return result * x;
+}
+
+// sin^2(angle / 2) for an angle of 0 to 180 degrees.
+double HalfAngleSinSquared(double degrees) {
+    const double sine = SinUpToHalfPi(degrees * DEGREES_TO_RADIANS / 2);
+    return sine * sine;
+}
+
+// Difference of two longitudes in [-180, 180], the short way around. Across
+// the antimeridian it is summed from the distances to it, which, unlike
+// 360 - |from - to|, loses nothing when the points are close.
+double LongitudeDifference(double from, double to) {
+    return std::min(std::abs(from - to),
+                    (180 - std::abs(from)) + (180 - std::abs(to)));
+}
+
+// Haversine of the central angle between from and to.
+double Haversine(const TrigCoordinates& from, const TrigCoordinates& to) {
+    const double haversine =
+        HalfAngleSinSquared(std::abs(to.lat - from.lat)) +
+        from.cos_lat * to.cos_lat *
+            HalfAngleSinSquared(LongitudeDifference(from.lng, to.lng));
+    return std::min(haversine, 1.0);
+}
+
+double HaversineToDistance(double haversine) {
+    return 2 * EARTH_RADIUS * std::asin(std::sqrt(haversine));
+}
+
+}  // namespace
+
+TrigCoordinates ToTrigCoordinates(Coordinates coordinates) {
+    return {coordinates.lat, coordinates.lng,
+            std::cos(coordinates.lat * DEGREES_TO_RADIANS)};
+}
+
+double ComputeDistance(const TrigCoordinates& from, const TrigCoordinates& to) {
+    return HaversineToDistance(Haversine(from, to));
+}
+
+void ComputeDistances(const TrigCoordinates* from, const TrigCoordinates* to,
+                      size_t count, double* distances) {
+    for (size_t i = 0; i < count; ++i) {
+        distances[i] = Haversine(from[i], to[i]);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        distances[i] = HaversineToDistance(distances[i]);
+    }
+}
+
 }  // namespace trc::geo
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cmath>
+#include <cstddef>
 #include <iostream>
 
 namespace trc {
@@ -14,18 +15,45 @@ struct Coordinates {
     bool operator!=(const Coordinates other) const;
 };
 
+inline constexpr double DEGREES_TO_RADIANS = 3.1415926535 / 180.;
+inline constexpr double EARTH_RADIUS = 6371'000.0;
+
 inline double ComputeDistance(Coordinates from, Coordinates to) {
     using namespace std;
     if (from == to) {
         return 0;
     }
-    static const double dr = 3.1415926535 / 180.;
-    static const double earth_r = 6371'000.0;
+    const double dr = DEGREES_TO_RADIANS;
     return acos(sin(from.lat * dr) * sin(to.lat * dr) +
                 cos(from.lat * dr) * cos(to.lat * dr) *
                     cos(abs(from.lng - to.lng) * dr)) *
-           earth_r;
+           EARTH_RADIUS;
 }
 
+// A point prepared for repeated distance computations: the cosine of the
+// latitude is all the haversine formula needs from either endpoint besides
+// the angles. These stay in degrees, as the difference of close angles is
+// exact there and would not be after a conversion. Worth caching per stop.
+struct TrigCoordinates {
+    double lat;
+    double lng;
+    double cos_lat;
+};
+
+TrigCoordinates ToTrigCoordinates(Coordinates coordinates);
+
+// Haversine distance for longitudes within [-180, 180]. Unlike the acos
+// form of ComputeDistance it keeps its precision for close points, which
+// the acos form can get wrong in the fourth digit at a few meters.
+double ComputeDistance(const TrigCoordinates& from, const TrigCoordinates& to);
+
+// distances[i] = ComputeDistance(from[i], to[i]) for i < count. The sines
+// come from a polynomial with an absolute error below 3e-16, in a loop free
+// of library calls that GCC vectorizes at -O3 (at -O2 it does not); only
+// asin remains a library call per pair. The relative error stays below
+// 1e-13 except for nearly antipodal points, where asin magnifies it.
+void ComputeDistances(const TrigCoordinates* from, const TrigCoordinates* to,
+                      size_t count, double* distances);
+
 }  // namespace geo
 }  // namespace trc
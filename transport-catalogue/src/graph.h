@@ -3,6 +3,7 @@
 #include <cstdlib>
 #include <vector>
 
+#include "memory_usage.h"
 #include "ranges.h"
 
 namespace graph {
@@ -37,6 +38,8 @@ class DirectedWeightedGraph {
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
     const std::vector<IncidenceList>& GetIncidenceList() const;
 
+    memory::MemoryUsage GetMemoryUsage() const;
+
    private:
     std::vector<Edge<Weight>> edges_;
     std::vector<IncidenceList> incidence_lists_;
@@ -82,4 +85,17 @@ DirectedWeightedGraph<Weight>::GetIncidenceList() const {
     return incidence_lists_;
 }
 
+template <typename Weight>
+memory::MemoryUsage DirectedWeightedGraph<Weight>::GetMemoryUsage() const {
+    size_t incidence_lists = memory::GetCapacityBytes(incidence_lists_);
+    for (const auto& incidence_list : incidence_lists_) {
+        incidence_lists += memory::GetCapacityBytes(incidence_list);
+    }
+
+    memory::MemoryUsage usage;
+    usage.Add("edges", memory::GetCapacityBytes(edges_));
+    usage.Add("incidence_lists", incidence_lists);
+    return usage;
+}
+
 }  // namespace graph
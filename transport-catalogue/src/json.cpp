@@ -1,6 +1,10 @@
 #include "json.h"
 
-#include <iterator>
+#include <algorithm>
+#include <charconv>
+#include <string_view>
+#include <system_error>
+#include <utility>
 
 namespace json {
 
@@ -93,218 +97,378 @@ const Node::Value& Node::GetValue() const { return *this; }
 namespace {
 using namespace std::literals;
 
-Node LoadNode(std::istream& input);
-Node LoadString(std::istream& input);
+bool IsSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' ||
+           c == '\f';
+}
 
-std::string LoadLiteral(std::istream& input) {
-    std::string s;
-    while (std::isalpha(input.peek())) {
-        s.push_back(static_cast<char>(input.get()));
-    }
-    return s;
+bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+bool IsAlpha(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
 }
 
-Node LoadArray(std::istream& input) {
-    std::vector<Node> result;
+// Takes what input already holds, waiting only when it holds nothing. The
+// tied stream is flushed before waiting, as before any input operation, so
+// that output for what has been read is out before more input is awaited.
+size_t ReadAvailable(std::istream& input, char* data, size_t size) {
+    std::streambuf& buffer = *input.rdbuf();
+    std::streamsize available = buffer.in_avail();
 
-    for (char c; input >> c && c != ']';) {
-        if (c != ',') {
-            input.putback(c);
+    if (available == 0) {
+        if (std::ostream* tied = input.tie()) {
+            tied->flush();
+        }
+        if (buffer.sgetc() == std::char_traits<char>::eof()) {
+            return 0;
         }
-        result.push_back(LoadNode(input));
+        available = std::max<std::streamsize>(buffer.in_avail(), 1);
     }
-    if (!input) {
-        throw ParsingError("Array parsing error"s);
+    if (available < 0) {
+        return 0;
     }
-    return Node(std::move(result));
+
+    return static_cast<size_t>(buffer.sgetn(
+        data, std::min(available, static_cast<std::streamsize>(size))));
 }
 
-Node LoadDict(std::istream& input) {
-    Dict dict;
+// Recursive descent over a contiguous buffer. Scanning is plain pointer
+// arithmetic, numbers go through std::from_chars and a string without
+// escapes is copied into its node in one go. Reading a stream, the buffer
+// holds the part not parsed yet and is refilled with whatever the stream
+// has once it runs out, so each value is parsed as soon as it has arrived.
+class Parser {
+   public:
+    explicit Parser(std::string_view text)
+        : pos_(text.data()), end_(text.data() + text.size()) {}
+
+    explicit Parser(std::istream& input)
+        : input_(&input), pos_(buffer_.data()), end_(pos_) {}
+
+    Node LoadNode() {
+        if (!SkipSpaces()) {
+            throw ParsingError("Unexpected EOF"s);
+        }
 
-    for (char c; input >> c && c != '}';) {
-        if (c == '"') {
-            std::string key = LoadString(input).AsString();
-            if (input >> c && c == ':') {
-                if (dict.find(key) != dict.end()) {
-                    throw ParsingError("Duplicate key '"s + key +
-                                       "' have been found");
-                }
-                dict.emplace(std::move(key), LoadNode(input));
-            } else {
-                throw ParsingError(": is expected but '"s + c +
-                                   "' has been found"s);
-            }
-        } else if (c != ',') {
-            throw ParsingError(R"(',' is expected but ')"s + c +
-                               "' has been found"s);
+        switch (*pos_) {
+            case '[':
+                ++pos_;
+                return LoadArray();
+            case '{':
+                ++pos_;
+                return LoadDict();
+            case '"':
+                ++pos_;
+                return Node(LoadString());
+            case 't':
+                [[fallthrough]];
+            case 'f':
+                return LoadBool();
+            case 'n':
+                return LoadNull();
+            default:
+                return LoadNumber();
         }
     }
-    if (!input) {
-        throw ParsingError("Dictionary parsing error"s);
-    }
-    return Node(std::move(dict));
-}
 
-Node LoadString(std::istream& input) {
-    auto it = std::istreambuf_iterator<char>(input);
-    auto end = std::istreambuf_iterator<char>();
-    std::string s;
-    while (true) {
-        if (it == end) {
-            throw ParsingError("String parsing error");
+    Node LoadStreamingRoot(std::string_view streamed_key,
+                           const ElementHandler& on_element) {
+        if (!SkipSpaces() || *pos_ != '{') {
+            throw ParsingError("A dict is expected at the root"s);
         }
-        const char ch = *it;
-        if (ch == '"') {
-            ++it;
-            break;
-        } else if (ch == '\\') {
-            ++it;
-            if (it == end) {
-                throw ParsingError("String parsing error");
+        ++pos_;
+
+        Dict dict;
+        bool is_streamed = false;
+
+        LoadEntries([&](std::string&& key) {
+            if (key != streamed_key) {
+                LoadEntry(dict, std::move(key));
+                return;
             }
-            const char escaped_char = *(it);
-            switch (escaped_char) {
-                case 'n':
-                    s.push_back('\n');
-                    break;
-                case 't':
-                    s.push_back('\t');
-                    break;
-                case 'r':
-                    s.push_back('\r');
-                    break;
-                case '"':
-                    s.push_back('"');
-                    break;
-                case '\\':
-                    s.push_back('\\');
-                    break;
-                default:
-                    throw ParsingError("Unrecognized escape sequence \\"s +
-                                       escaped_char);
+
+            if (is_streamed) {
+                throw ParsingError("Duplicate key '"s + key +
+                                   "' have been found");
             }
-        } else if (ch == '\n' || ch == '\r') {
-            throw ParsingError("Unexpected end of line"s);
-        } else {
-            s.push_back(ch);
+            is_streamed = true;
+
+            if (!SkipSpaces() || *pos_ != '[') {
+                throw ParsingError("An array is expected under '"s + key +
+                                   "'"s);
+            }
+            ++pos_;
+            LoadElements([&] { on_element(LoadNode(), dict); });
+        });
+
+        return Node(std::move(dict));
+    }
+
+   private:
+    static constexpr size_t CHUNK_SIZE = 1 << 16;
+
+    std::istream* input_ = nullptr;
+    std::string buffer_;
+    const char* pos_;
+    const char* end_;
+    // Start of the token being scanned, kept in the buffer across refills.
+    const char* token_begin_ = nullptr;
+
+    // True at the end of input, once the buffer cannot be refilled.
+    bool AtEnd() { return pos_ == end_ && !Refill(); }
+
+    // Appends what the stream has to the rest of the buffer, dropping what
+    // has been parsed except the token being scanned; false at the end.
+    bool Refill() {
+        if (input_ == nullptr) {
+            return false;
         }
-        ++it;
+
+        const char* keep = token_begin_ != nullptr ? token_begin_ : pos_;
+        const size_t pos_offset = pos_ - keep;
+        buffer_.erase(0, keep - buffer_.data());
+
+        const size_t size = buffer_.size();
+        buffer_.resize(size + CHUNK_SIZE);
+        buffer_.resize(size + ReadAvailable(*input_, buffer_.data() + size,
+                                            CHUNK_SIZE));
+
+        pos_ = buffer_.data() + pos_offset;
+        end_ = buffer_.data() + buffer_.size();
+        if (token_begin_ != nullptr) {
+            token_begin_ = buffer_.data();
+        }
+
+        return buffer_.size() > size;
     }
 
-    return Node(std::move(s));
-}
+    // Moves to the next non-space character; false at the end of input.
+    bool SkipSpaces() {
+        while (!AtEnd() && IsSpace(*pos_)) {
+            ++pos_;
+        }
+        return pos_ != end_;
+    }
+
+    // The view lasts until the buffer is next refilled.
+    std::string_view LoadLiteral() {
+        token_begin_ = pos_;
+        while (!AtEnd() && IsAlpha(*pos_)) {
+            ++pos_;
+        }
 
-Node LoadBool(std::istream& input) {
-    const auto s = LoadLiteral(input);
-    if (s == "true"sv) {
-        return Node{true};
-    } else if (s == "false"sv) {
-        return Node{false};
-    } else {
-        throw ParsingError("Failed to parse '"s + s + "' as bool"s);
+        const char* begin = std::exchange(token_begin_, nullptr);
+        return {begin, static_cast<size_t>(pos_ - begin)};
     }
-}
 
-Node LoadNull(std::istream& input) {
-    if (auto literal = LoadLiteral(input); literal == "null"sv) {
-        return Node{nullptr};
-    } else {
-        throw ParsingError("Failed to parse '"s + literal + "' as null"s);
+    Node LoadArray() {
+        Array result;
+        LoadElements([&] { result.push_back(LoadNode()); });
+        return Node(std::move(result));
     }
-}
 
-Node LoadNumber(std::istream& input) {
-    std::string parsed_num;
+    Node LoadDict() {
+        Dict dict;
+
+        LoadEntries(
+            [&](std::string&& key) { LoadEntry(dict, std::move(key)); });
+
+        return Node(std::move(dict));
+    }
 
-    // Считывает в parsed_num очередной символ из input
-    auto read_char = [&parsed_num, &input] {
-        parsed_num += static_cast<char>(input.get());
-        if (!input) {
-            throw ParsingError("Failed to read number from stream"s);
+    void LoadEntry(Dict& dict, std::string&& key) {
+        // One descent both checks for a duplicate and inserts.
+        const auto [it, is_new] = dict.try_emplace(std::move(key));
+        if (!is_new) {
+            throw ParsingError("Duplicate key '"s + it->first +
+                               "' have been found");
         }
-    };
+        it->second = LoadNode();
+    }
 
-    // Считывает одну или более цифр в parsed_num из input
-    auto read_digits = [&input, read_char] {
-        if (!std::isdigit(input.peek())) {
-            throw ParsingError("A digit is expected"s);
+    // Walks the elements of an array whose '[' has been consumed; load_element
+    // must consume one value.
+    template <typename LoadElement>
+    void LoadElements(LoadElement load_element) {
+        while (SkipSpaces() && *pos_ != ']') {
+            if (*pos_ == ',') {
+                ++pos_;
+            }
+            load_element();
         }
-        while (std::isdigit(input.peek())) {
-            read_char();
+        if (pos_ == end_) {
+            throw ParsingError("Array parsing error"s);
         }
-    };
+        ++pos_;
+    }
+
+    // Walks the entries of a dict whose '{' has been consumed; load_value is
+    // given each key and must consume its value.
+    template <typename LoadValue>
+    void LoadEntries(LoadValue load_value) {
+        while (SkipSpaces() && *pos_ != '}') {
+            const char c = *pos_++;
+
+            if (c == '"') {
+                std::string key = LoadString();
+
+                if (!SkipSpaces() || *pos_ != ':') {
+                    const std::string found =
+                        pos_ == end_ ? ""s : std::string(1, *pos_);
+                    throw ParsingError(": is expected but '"s + found +
+                                       "' has been found"s);
+                }
+                ++pos_;
 
-    if (input.peek() == '-') {
-        read_char();
+                load_value(std::move(key));
+            } else if (c != ',') {
+                throw ParsingError(R"(',' is expected but ')"s + c +
+                                   "' has been found"s);
+            }
+        }
+        if (pos_ == end_) {
+            throw ParsingError("Dictionary parsing error"s);
+        }
+        ++pos_;
     }
-    // Парсим целую часть числа
-    if (input.peek() == '0') {
-        read_char();
-        // После 0 в JSON не могут идти другие цифры
-    } else {
-        read_digits();
+
+    // Reads up to and including the closing quote.
+    std::string LoadString() {
+        token_begin_ = pos_;
+
+        while (!AtEnd() && *pos_ != '"' && *pos_ != '\\' && *pos_ != '\n' &&
+               *pos_ != '\r') {
+            ++pos_;
+        }
+
+        std::string s(std::exchange(token_begin_, nullptr), pos_);
+
+        while (true) {
+            if (AtEnd()) {
+                throw ParsingError("String parsing error");
+            }
+
+            const char ch = *pos_++;
+
+            if (ch == '"') {
+                break;
+            } else if (ch == '\\') {
+                if (AtEnd()) {
+                    throw ParsingError("String parsing error");
+                }
+                const char escaped_char = *pos_++;
+                switch (escaped_char) {
+                    case 'n':
+                        s.push_back('\n');
+                        break;
+                    case 't':
+                        s.push_back('\t');
+                        break;
+                    case 'r':
+                        s.push_back('\r');
+                        break;
+                    case '"':
+                        s.push_back('"');
+                        break;
+                    case '\\':
+                        s.push_back('\\');
+                        break;
+                    default:
+                        throw ParsingError("Unrecognized escape sequence \\"s +
+                                           escaped_char);
+                }
+            } else if (ch == '\n' || ch == '\r') {
+                throw ParsingError("Unexpected end of line"s);
+            } else {
+                s.push_back(ch);
+            }
+        }
+
+        return s;
+    }
+
+    Node LoadBool() {
+        const std::string_view literal = LoadLiteral();
+        if (literal == "true"sv) {
+            return Node{true};
+        } else if (literal == "false"sv) {
+            return Node{false};
+        } else {
+            throw ParsingError("Failed to parse '"s + std::string(literal) +
+                               "' as bool"s);
+        }
     }
 
-    bool is_int = true;
-    // Парсим дробную часть числа
-    if (input.peek() == '.') {
-        read_char();
-        read_digits();
-        is_int = false;
+    Node LoadNull() {
+        if (const auto literal = LoadLiteral(); literal == "null"sv) {
+            return Node{nullptr};
+        } else {
+            throw ParsingError("Failed to parse '"s + std::string(literal) +
+                               "' as null"s);
+        }
     }
 
-    // Парсим экспоненциальную часть числа
-    if (int ch = input.peek(); ch == 'e' || ch == 'E') {
-        read_char();
-        if (ch = input.peek(); ch == '+' || ch == '-') {
-            read_char();
+    void SkipDigits() {
+        if (AtEnd() || !IsDigit(*pos_)) {
+            throw ParsingError("A digit is expected"s);
+        }
+        while (!AtEnd() && IsDigit(*pos_)) {
+            ++pos_;
         }
-        read_digits();
-        is_int = false;
     }
 
-    try {
+    // Validates the JSON number grammar first, since from_chars accepts a
+    // wider one (e.g. leading zeros), then converts the scanned range.
+    Node LoadNumber() {
+        token_begin_ = pos_;
+
+        if (*pos_ == '-') {
+            ++pos_;
+        }
+        // No other digits may follow a leading 0.
+        if (!AtEnd() && *pos_ == '0') {
+            ++pos_;
+        } else {
+            SkipDigits();
+        }
+
+        bool is_int = true;
+
+        if (!AtEnd() && *pos_ == '.') {
+            ++pos_;
+            SkipDigits();
+            is_int = false;
+        }
+
+        if (!AtEnd() && (*pos_ == 'e' || *pos_ == 'E')) {
+            ++pos_;
+            if (!AtEnd() && (*pos_ == '+' || *pos_ == '-')) {
+                ++pos_;
+            }
+            SkipDigits();
+            is_int = false;
+        }
+
+        const char* begin = std::exchange(token_begin_, nullptr);
+
         if (is_int) {
-            // Сначала пробуем преобразовать строку в int
-            try {
-                return std::stoi(parsed_num);
-            } catch (...) {
-                // В случае неудачи, например, при переполнении
-                // код ниже попробует преобразовать строку в double
+            int value;
+            // An int that overflows is read as a double below.
+            if (const auto [end, error] = std::from_chars(begin, pos_, value);
+                error == std::errc{} && end == pos_) {
+                return value;
             }
         }
-        return std::stod(parsed_num);
-    } catch (...) {
-        throw ParsingError("Failed to convert "s + parsed_num + " to number"s);
-    }
-}
 
-Node LoadNode(std::istream& input) {
-    char c;
-    if (!(input >> c)) {
-        throw ParsingError("Unexpected EOF"s);
-    }
-    switch (c) {
-        case '[':
-            return LoadArray(input);
-        case '{':
-            return LoadDict(input);
-        case '"':
-            return LoadString(input);
-        case 't':
-            [[fallthrough]];
-        case 'f':
-            input.putback(c);
-            return LoadBool(input);
-        case 'n':
-            input.putback(c);
-            return LoadNull(input);
-        default:
-            input.putback(c);
-            return LoadNumber(input);
+        double value;
+        if (const auto [end, error] = std::from_chars(begin, pos_, value);
+            error != std::errc{} || end != pos_) {
+            throw ParsingError("Failed to convert "s +
+                               std::string(begin, pos_) + " to number"s);
+        }
+        return value;
     }
-}
+};
 
 struct PrintContext {
     std::ostream& out;
@@ -423,10 +587,47 @@ void PrintNode(const Node& node, const PrintContext& ctx) {
 
 }  // namespace
 
-Document Load(std::istream& input) { return Document{LoadNode(input)}; }
+Document Load(std::string_view text) {
+    return Document{Parser(text).LoadNode()};
+}
+
+Document Load(std::istream& input) {
+    return Document{Parser(input).LoadNode()};
+}
+
+Document LoadStreaming(std::string_view text, std::string_view streamed_key,
+                       const ElementHandler& on_element) {
+    return Document{Parser(text).LoadStreamingRoot(streamed_key, on_element)};
+}
+
+Document LoadStreaming(std::istream& input, std::string_view streamed_key,
+                       const ElementHandler& on_element) {
+    return Document{Parser(input).LoadStreamingRoot(streamed_key, on_element)};
+}
 
 void Print(const Document& doc, std::ostream& output) {
     PrintNode(doc.GetRoot(), PrintContext{output});
 }
 
+ArrayPrinter::ArrayPrinter(std::ostream& output) : output_(output) {}
+
+void ArrayPrinter::Print(const Node& element) {
+    output_ << (size_ == 0 ? "[\n"sv : ",\n"sv);
+
+    const auto inner_ctx = PrintContext{output_}.Indented();
+    inner_ctx.PrintIndent();
+    PrintNode(element, inner_ctx);
+
+    ++size_;
+}
+
+void ArrayPrinter::Finish() {
+    if (size_ == 0) {
+        output_ << "[\n"sv;
+    }
+    output_ << "\n]"sv;
+}
+
+size_t ArrayPrinter::GetSize() const { return size_; }
+
 }  // namespace json
@@ -1,15 +1,18 @@
 #pragma once
 
+#include <functional>
 #include <iostream>
 #include <map>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
 namespace json {
 
 class Node;
-using Dict = std::map<std::string, Node>;
+// std::less<> lets keys be looked up by std::string_view without a copy.
+using Dict = std::map<std::string, Node, std::less<>>;
 using Array = std::vector<Node>;
 
 class ParsingError : public std::runtime_error {
@@ -76,8 +79,48 @@ inline bool operator!=(const Document& lhs, const Document& rhs) {
     return !(lhs == rhs);
 }
 
+// Parses the first JSON value of text; anything after it is ignored.
+Document Load(std::string_view text);
+
+// Parses the first JSON value of input as it is read, waiting for more only
+// when the value is not complete yet. Characters after the value may have
+// been consumed.
 Document Load(std::istream& input);
 
+// Receives an element of a streamed array along with the root entries that
+// were parsed before the array.
+using ElementHandler =
+    std::function<void(Node element, const Dict& preceding)>;
+
+// Parses text whose root must be a dict, except that the elements of the
+// array under streamed_key are handed to on_element one at a time as soon as
+// each is parsed, and are not kept; the returned document lacks that key.
+Document LoadStreaming(std::string_view text, std::string_view streamed_key,
+                       const ElementHandler& on_element);
+
+// Each element is handed over as soon as it has arrived, before the rest of
+// input is read.
+Document LoadStreaming(std::istream& input, std::string_view streamed_key,
+                       const ElementHandler& on_element);
+
 void Print(const Document& doc, std::ostream& output);
 
+// Prints an array one element at a time, in exactly the layout Print gives
+// the whole array, so that the array never has to be held.
+class ArrayPrinter {
+   public:
+    explicit ArrayPrinter(std::ostream& output);
+
+    void Print(const Node& element);
+
+    // Closes the array.
+    void Finish();
+
+    size_t GetSize() const;
+
+   private:
+    std::ostream& output_;
+    size_t size_ = 0;
+};
+
 }  // namespace json
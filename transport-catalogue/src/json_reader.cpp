@@ -1,6 +1,8 @@
 #include "json_reader.h"
 
 #include <algorithm>
+#include <stdexcept>
+#include <string_view>
 
 #include "json.h"
 
@@ -10,6 +12,83 @@ using namespace std;
 
 JsonReader::JsonReader(istream& input) : document_(json::Load(input)) {}
 
+JsonReader::JsonReader(json::Document document)
+    : document_(std::move(document)) {}
+
+JsonReader::JsonReader(string_view text, const BaseRequestVisitor& visitor)
+    : document_(json::LoadStreaming(
+          text, BASE_REQUESTS_FIELD,
+          [&](json::Node base_request, const json::Dict&) {
+              const json::Dict& properties = base_request.AsDict();
+              const string& type = properties.at(TYPE_FIELD).AsString();
+
+              if (type == STOP_TYPE_FIELD) {
+                  visitor.on_stop(ParseStop(properties));
+              } else if (type == BUS_TYPE_FIELD) {
+                  visitor.on_bus(ParseBus(properties));
+              }
+          })) {}
+
+JsonReader::JsonReader(istream& input, const StatRequestVisitor& visitor)
+    : document_(LoadStatRequests(input, visitor)) {}
+
+BaseRequestCounts CountBaseRequests(string_view text) {
+    BaseRequestCounts counts;
+
+    // Key each open dict or array is the value of; empty for the root and
+    // for array elements.
+    vector<string_view> container_keys;
+    string_view key;
+
+    for (size_t pos = 0; pos < text.size(); ++pos) {
+        const char c = text[pos];
+
+        if (c == '"') {
+            const size_t begin = ++pos;
+            while (pos < text.size() && text[pos] != '"') {
+                pos += text[pos] == '\\' ? 2 : 1;
+            }
+            const string_view token = text.substr(begin, pos - begin);
+
+            const size_t next = text.find_first_not_of(" \t\r\n", pos + 1);
+            const bool is_key = next != string_view::npos && text[next] == ':';
+            if (is_key) {
+                key = token;
+            }
+
+            // Only the requests of the base_requests array are counted.
+            if (container_keys.size() < 2 ||
+                container_keys[1] != BASE_REQUESTS_FIELD) {
+                continue;
+            }
+
+            const string_view parent = container_keys.back();
+            if (is_key && parent == ROAD_DISTANCES_FIELD) {
+                ++counts.distance_count;
+            } else if (is_key && token == LATITUDE_FIELD) {
+                ++counts.stop_count;
+            } else if (!is_key && parent == STOPS_FIELD) {
+                ++counts.route_stop_count;
+            }
+        } else if (c == '{' || c == '[') {
+            if (c == '[' && key == STOPS_FIELD && container_keys.size() > 1 &&
+                container_keys[1] == BASE_REQUESTS_FIELD) {
+                ++counts.bus_count;
+            }
+            container_keys.push_back(key);
+            key = {};
+        } else if (c == '}' || c == ']') {
+            if (!container_keys.empty()) {
+                container_keys.pop_back();
+            }
+        } else if (c == ',') {
+            key = {};
+        }
+    }
+
+    return counts;
+}
+
 vector<AddStopRequest> JsonReader::GetStops() const {
     vector<AddStopRequest> parsed_stops;
 
@@ -48,6 +127,17 @@ vector<StatRequest> JsonReader::GetStatRequests() const {
     return stat_requests;
 }
 
+vector<string> JsonReader::GetStatRequestRegions() const {
+    vector<string> regions;
+
+    for (const auto& stat_request :
+         document_.GetRoot().AsDict().at(STAT_REQUESTS_FIELD).AsArray()) {
+        regions.push_back(ParseRegion(stat_request.AsDict()));
+    }
+
+    return regions;
+}
+
 render::RenderSettings JsonReader::GetRenderSettings() const {
     json::Dict settings_json =
         document_.GetRoot().AsDict().at(RENDER_SETTINGS_FIELD).AsDict();
@@ -70,15 +160,160 @@ TransportRouter::Settings JsonReader::GetRoutingSettings() const {
     json::Dict settings_json =
         document_.GetRoot().AsDict().at(ROUTING_SETTINGS_FIELD).AsDict();
 
-    return {settings_json.at(BUS_WAIT_TIME_FIELD).AsDouble(),
-            settings_json.at(BUS_VELOCITY_FIELD).AsDouble()};
+    TransportRouter::Settings settings;
+    settings.bus_wait_time = settings_json.at(BUS_WAIT_TIME_FIELD).AsDouble();
+    settings.bus_velocity = settings_json.at(BUS_VELOCITY_FIELD).AsDouble();
+
+    if (settings_json.count(MAX_EXPANDED_VERTICES_FIELD)) {
+        settings.max_expanded_vertices =
+            ParseLimit(settings_json, MAX_EXPANDED_VERTICES_FIELD);
+    }
+
+    if (settings_json.count(ENGINE_FIELD)) {
+        settings.engine =
+            ParseEngine(settings_json.at(ENGINE_FIELD).AsString());
+    }
+
+    if (settings_json.count(MEMORY_BUDGET_MB_FIELD)) {
+        settings.memory_budget_mb =
+            ParseLimit(settings_json, MEMORY_BUDGET_MB_FIELD);
+    }
+
+    if (settings_json.count(MAX_BUILD_TIME_FIELD)) {
+        settings.max_build_time =
+            settings_json.at(MAX_BUILD_TIME_FIELD).AsDouble();
+    }
+
+    return settings;
+}
+
+bool JsonReader::HasSerializationSettings() const {
+    return document_.GetRoot().AsDict().count(SERIALIZATION_SETTINGS_FIELD) >
+           0;
 }
 
 SerializationSettings JsonReader::GetSerializationSettings() const {
-    json::Dict settings_json =
+    SerializationSettings settings =
+        ParseFileSettings(SERIALIZATION_SETTINGS_FIELD);
+
+    settings.deltas = ParseDeltas(
+        document_.GetRoot().AsDict().at(SERIALIZATION_SETTINGS_FIELD).AsDict());
+
+    return settings;
+}
+
+vector<ShardSettings> JsonReader::GetShardSettings() const {
+    const json::Dict& settings_json =
         document_.GetRoot().AsDict().at(SERIALIZATION_SETTINGS_FIELD).AsDict();
 
-    return {settings_json.at(FILE_FIELD).AsString()};
+    vector<ShardSettings> shards;
+
+    if (!settings_json.count(SHARDS_FIELD)) {
+        return shards;
+    }
+
+    for (const auto& shard : settings_json.at(SHARDS_FIELD).AsArray()) {
+        const json::Dict& shard_json = shard.AsDict();
+
+        shards.push_back(
+            {shard_json.at(REGION_FIELD).AsString(),
+             shard_json.count(STOP_PREFIX_FIELD)
+                 ? shard_json.at(STOP_PREFIX_FIELD).AsString()
+                 : string(),
+             {shard_json.at(FILE_FIELD).AsString(), ParseDeltas(shard_json)}});
+    }
+
+    return shards;
+}
+
+SerializationSettings JsonReader::GetDeltaSettings() const {
+    return ParseFileSettings(DELTA_SETTINGS_FIELD);
+}
+
+SerializationSettings JsonReader::GetCompactionSettings() const {
+    return ParseFileSettings(COMPACTION_SETTINGS_FIELD);
+}
+
+NetworkDelta JsonReader::GetDelta() const {
+    NetworkDelta delta;
+
+    for (const auto& base_request :
+         document_.GetRoot().AsDict().at(BASE_REQUESTS_FIELD).AsArray()) {
+        const json::Dict& properties = base_request.AsDict();
+        const string& type = properties.at(TYPE_FIELD).AsString();
+        const string& name = properties.at(NAME_FIELD).AsString();
+
+        if (type == STOP_TYPE_FIELD) {
+            if (properties.count(LATITUDE_FIELD)) {
+                delta.stops.push_back(
+                    {name,
+                     {properties.at(LATITUDE_FIELD).AsDouble(),
+                      properties.at(LONGITUDE_FIELD).AsDouble()}});
+            }
+
+            if (properties.count(ROAD_DISTANCES_FIELD)) {
+                for (const auto& [to, distance] :
+                     properties.at(ROAD_DISTANCES_FIELD).AsDict()) {
+                    delta.distances.push_back({name, to, distance.AsDouble()});
+                }
+            }
+        } else if (type == BUS_TYPE_FIELD) {
+            AddBusRequest bus = ParseBus(properties);
+            delta.buses.push_back(
+                {move(bus.name), move(bus.stops), bus.is_roundtrip});
+        } else if (type == REMOVE_STOP_TYPE_FIELD) {
+            delta.removed_stops.push_back(name);
+        } else if (type == REMOVE_BUS_TYPE_FIELD) {
+            delta.removed_buses.push_back(name);
+        }
+    }
+
+    return delta;
+}
+
+json::Document JsonReader::LoadStatRequests(
+    istream& input, const StatRequestVisitor& visitor) const {
+    // The sections before stat_requests are complete by the time its first
+    // element is parsed, so they are copied out once.
+    optional<JsonReader> preceding;
+
+    return json::LoadStreaming(
+        input, STAT_REQUESTS_FIELD,
+        [&](json::Node stat_request, const json::Dict& preceding_sections) {
+            if (!preceding) {
+                preceding.emplace(json::Document{preceding_sections});
+            }
+
+            const json::Dict& properties = stat_request.AsDict();
+            visitor(ParseStatRequest(properties), ParseRegion(properties),
+                    *preceding);
+        });
+}
+
+string JsonReader::ParseRegion(const json::Dict& stat_request) const {
+    return stat_request.count(REGION_FIELD)
+               ? stat_request.at(REGION_FIELD).AsString()
+               : string();
+}
+
+SerializationSettings JsonReader::ParseFileSettings(const string& field) const {
+    const json::Dict& settings_json =
+        document_.GetRoot().AsDict().at(field).AsDict();
+
+    return {settings_json.at(FILE_FIELD).AsString(), {}};
+}
+
+vector<SerializationSettings::Path> JsonReader::ParseDeltas(
+    const json::Dict& settings_json) const {
+    vector<SerializationSettings::Path> deltas;
+
+    if (settings_json.count(DELTAS_FIELD)) {
+        for (const auto& delta : settings_json.at(DELTAS_FIELD).AsArray()) {
+            deltas.emplace_back(delta.AsString());
+        }
+    }
+
+    return deltas;
 }
 
 AddStopRequest JsonReader::ParseStop(const json::Dict& stop_properties) const {
@@ -120,6 +355,24 @@ vector<string> JsonReader::ParseRouteStops(
 StatRequest JsonReader::ParseStatRequest(const json::Dict& stat_request) const {
     const std::string& request_type = stat_request.at(TYPE_FIELD).AsString();
 
+    try {
+        return ParseTypedStatRequest(request_type, stat_request);
+    } catch (const logic_error&) {
+        // Missing or mistyped fields: the request can still be answered
+        // with an error as long as its id can be read.
+        const auto id = stat_request.find(ID_FIELD);
+
+        if (id == stat_request.end() || !id->second.IsInt()) {
+            throw;
+        }
+
+        return InvalidRequest{id->second.AsInt(),
+                              "Malformed " + request_type + " request"};
+    }
+}
+
+StatRequest JsonReader::ParseTypedStatRequest(
+    const string& request_type, const json::Dict& stat_request) const {
     if (request_type == "Stop") {
         return GetStopRequest{stat_request.at(ID_FIELD).AsInt(),
                               stat_request.at(NAME_FIELD).AsString()};
@@ -129,9 +382,21 @@ StatRequest JsonReader::ParseStatRequest(const json::Dict& stat_request) const {
     } else if (request_type == "Map") {
         return GetMapRequest{stat_request.at(ID_FIELD).AsInt()};
     } else if (request_type == "Route") {
-        return GetRouteRequest{stat_request.at(ID_FIELD).AsInt(),
-                               stat_request.at(FROM_FIELD).AsString(),
-                               stat_request.at(TO_FIELD).AsString()};
+        return GetRouteRequest{
+            stat_request.at(ID_FIELD).AsInt(),
+            stat_request.at(FROM_FIELD).AsString(),
+            stat_request.at(TO_FIELD).AsString(),
+            stat_request.count(ALTERNATIVES_FIELD)
+                ? stat_request.at(ALTERNATIVES_FIELD).AsInt()
+                : 1};
+    } else if (request_type == "Isochrone") {
+        return GetIsochroneRequest{stat_request.at(ID_FIELD).AsInt(),
+                                   stat_request.at(FROM_FIELD).AsString(),
+                                   stat_request.at(MAX_TIME_FIELD).AsDouble()};
+    } else if (request_type == "NearbyStops") {
+        return ParseNearbyStops(stat_request);
+    } else if (request_type == "Suggest") {
+        return ParseSuggest(stat_request);
     } else {
         return UnknownRequest{};
     }
@@ -169,6 +434,95 @@ std::vector<svg::Color> JsonReader::ParseColorPalette(
     return color_palette;
 }
 
+StatRequest JsonReader::ParseNearbyStops(
+    const json::Dict& stat_request) const {
+    GetNearbyStopsRequest request{
+        stat_request.at(ID_FIELD).AsInt(),
+        {stat_request.at(LATITUDE_FIELD).AsDouble(),
+         stat_request.at(LONGITUDE_FIELD).AsDouble()},
+        nullopt,
+        nullopt};
+
+    if (stat_request.count(COUNT_FIELD)) {
+        const int count = stat_request.at(COUNT_FIELD).AsInt();
+
+        if (count < 0) {
+            return InvalidRequest{request.id,
+                                  "NearbyStops count must not be negative"};
+        }
+
+        request.count = count;
+    }
+
+    if (stat_request.count(RADIUS_FIELD)) {
+        request.radius = stat_request.at(RADIUS_FIELD).AsDouble();
+    }
+
+    if (!request.count && !request.radius) {
+        return InvalidRequest{request.id,
+                              "NearbyStops request needs a count or a radius"};
+    }
+
+    return request;
+}
+
+StatRequest JsonReader::ParseSuggest(const json::Dict& stat_request) const {
+    GetSuggestRequest request{stat_request.at(ID_FIELD).AsInt(),
+                              stat_request.at(PREFIX_FIELD).AsString()};
+
+    if (stat_request.count(KIND_FIELD)) {
+        const string& kind = stat_request.at(KIND_FIELD).AsString();
+
+        if (kind != STOP_TYPE_FIELD && kind != BUS_TYPE_FIELD) {
+            return InvalidRequest{request.id,
+                                  "Suggest kind must be Stop or Bus"};
+        }
+
+        request.is_bus = kind == BUS_TYPE_FIELD;
+    }
+
+    if (stat_request.count(COUNT_FIELD)) {
+        const int count = stat_request.at(COUNT_FIELD).AsInt();
+
+        if (count < 0) {
+            return InvalidRequest{request.id,
+                                  "Suggest count must not be negative"};
+        }
+
+        request.count = count;
+    }
+
+    if (stat_request.count(RANKED_FIELD)) {
+        request.is_ranked = stat_request.at(RANKED_FIELD).AsBool();
+    }
+
+    return request;
+}
+
+TransportRouter::Engine JsonReader::ParseEngine(const string& engine) const {
+    for (auto candidate :
+         {TransportRouter::Engine::AUTO, TransportRouter::Engine::ALL_PAIRS,
+          TransportRouter::Engine::DIJKSTRA}) {
+        if (TransportRouter::GetEngineName(candidate) == engine) {
+            return candidate;
+        }
+    }
+
+    throw invalid_argument("Unsupported routing engine: " + engine);
+}
+
+size_t JsonReader::ParseLimit(const json::Dict& settings,
+                              const string& field) const {
+    const int limit = settings.at(field).AsInt();
+
+    if (limit < 0) {
+        throw invalid_argument(field + " must not be negative: " +
+                               to_string(limit));
+    }
+
+    return static_cast<size_t>(limit);
+}
+
 svg::Point JsonReader::ParsePoint(const json::Array& point) const {
     return {point[0].AsDouble(), point[1].AsDouble()};
 }
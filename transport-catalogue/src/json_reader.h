@@ -1,14 +1,18 @@
 #pragma once
 
+#include <functional>
 #include <istream>
 #include <map>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
 #include "json.h"
 #include "map_renderer.h"
 #include "serialization.h"
+#include "sharded_network.h"
 #include "transport_router.h"
 
 namespace trc::io {
@@ -59,9 +63,32 @@ inline const std::string WAIT_FIELD = "Wait";
 inline const std::string SPAN_COUNT_FIELD = "span_count";
 inline const std::string ITEMS_FIELD = "items";
 inline const std::string TOTAL_TIME_FIELD = "total_time";
+inline const std::string ALTERNATIVES_FIELD = "alternatives";
+inline const std::string ALTERNATIVES_LIMIT_REACHED_FIELD =
+    "alternatives_limit_reached";
+inline const std::string MAX_EXPANDED_VERTICES_FIELD = "max_expanded_vertices";
+inline const std::string MAX_TIME_FIELD = "max_time";
+inline const std::string ENGINE_FIELD = "engine";
+inline const std::string MEMORY_BUDGET_MB_FIELD = "memory_budget_mb";
+inline const std::string MAX_BUILD_TIME_FIELD = "max_build_time";
+inline const std::string COUNT_FIELD = "count";
+inline const std::string RADIUS_FIELD = "radius";
+inline const std::string DISTANCE_FIELD = "distance";
 inline const std::string SERIALIZATION_SETTINGS_FIELD =
     "serialization_settings";
 inline const std::string FILE_FIELD = "file";
+inline const std::string DELTAS_FIELD = "deltas";
+inline const std::string DELTA_SETTINGS_FIELD = "delta_settings";
+inline const std::string COMPACTION_SETTINGS_FIELD = "compaction_settings";
+inline const std::string REMOVE_STOP_TYPE_FIELD = "RemoveStop";
+inline const std::string REMOVE_BUS_TYPE_FIELD = "RemoveBus";
+inline const std::string SHARDS_FIELD = "shards";
+inline const std::string REGION_FIELD = "region";
+inline const std::string STOP_PREFIX_FIELD = "stop_prefix";
+inline const std::string PREFIX_FIELD = "prefix";
+inline const std::string KIND_FIELD = "kind";
+inline const std::string RANKED_FIELD = "ranked";
+inline const std::string NAMES_FIELD = "names";
 
 using StatRequstField = std::variant<std::string, int>;
 
@@ -98,32 +125,135 @@ struct GetRouteRequest {
     int id;
     std::string from_stop;
     std::string to_stop;
+    int alternatives = 1;
+};
+
+struct GetIsochroneRequest {
+    int id;
+    std::string from_stop;
+    double max_time;
+};
+
+// Either the count nearest stops or all stops within radius meters; with
+// both, the nearest count of those within radius.
+struct GetNearbyStopsRequest {
+    int id;
+    geo::Coordinates coordinates;
+    std::optional<size_t> count;
+    std::optional<double> radius;
+};
+
+// Up to count stop (or bus) names starting with prefix. Ranked puts the
+// stops served by most buses, or the buses with most stops, first.
+struct GetSuggestRequest {
+    int id;
+    std::string prefix;
+    bool is_bus = false;
+    size_t count = 10;
+    bool is_ranked = false;
+};
+
+// A request of a known type whose fields are missing or out of range. It is
+// answered with its own error so that the rest of the batch goes on.
+struct InvalidRequest {
+    int id;
+    std::string error_message;
 };
 
 struct UnknownRequest {};
 
-using StatRequest = std::variant<GetStopRequest, GetBusRequest, GetMapRequest,
-                                 GetRouteRequest, UnknownRequest>;
+using StatRequest =
+    std::variant<GetStopRequest, GetBusRequest, GetMapRequest, GetRouteRequest,
+                 GetIsochroneRequest, GetNearbyStopsRequest, GetSuggestRequest,
+                 InvalidRequest, UnknownRequest>;
+
+// Receives base requests while the input is still being parsed.
+struct BaseRequestVisitor {
+    std::function<void(AddStopRequest&&)> on_stop;
+    std::function<void(AddBusRequest&&)> on_bus;
+};
+
+// Sizes of the base requests of a document.
+struct BaseRequestCounts {
+    size_t stop_count = 0;
+    size_t bus_count = 0;
+    size_t route_stop_count = 0;
+    size_t distance_count = 0;
+};
+
+// Counts the base requests of a document from its text in one pass that
+// only follows strings and nesting, so that a catalogue can be sized before
+// the requests are parsed. Malformed text yields rough counts, not errors.
+BaseRequestCounts CountBaseRequests(std::string_view text);
+
+class JsonReader;
+
+// Receives a stat request while the input is still being parsed, with its
+// region (empty where none is given) and a reader over the sections that
+// came before stat_requests.
+using StatRequestVisitor =
+    std::function<void(StatRequest&& stat_request, std::string&& region,
+                       const JsonReader& preceding)>;
 
 class JsonReader {
    public:
     explicit JsonReader(std::istream& input);
 
+    explicit JsonReader(json::Document document);
+
+    // Hands each base request to visitor as soon as it is parsed, so the
+    // array is never held whole; GetStops, GetBuses and GetDelta are then
+    // unavailable.
+    JsonReader(std::string_view text, const BaseRequestVisitor& visitor);
+
+    // Hands each stat request to visitor as soon as it is parsed;
+    // GetStatRequests and GetStatRequestRegions are then unavailable.
+    JsonReader(std::istream& input, const StatRequestVisitor& visitor);
+
     std::vector<AddStopRequest> GetStops() const;
 
     std::vector<AddBusRequest> GetBuses() const;
 
     std::vector<StatRequest> GetStatRequests() const;
 
+    // Region of each stat request, empty where none is given.
+    std::vector<std::string> GetStatRequestRegions() const;
+
     render::RenderSettings GetRenderSettings() const;
 
     TransportRouter::Settings GetRoutingSettings() const;
 
+    bool HasSerializationSettings() const;
+
     SerializationSettings GetSerializationSettings() const;
 
+    // Shards listed in the serialization settings; empty when the settings
+    // name a single base file instead.
+    std::vector<ShardSettings> GetShardSettings() const;
+
+    // Output file of make_delta.
+    SerializationSettings GetDeltaSettings() const;
+
+    // Output file of compact_base.
+    SerializationSettings GetCompactionSettings() const;
+
+    // Base requests read as edits: a Stop without coordinates only updates
+    // road distances, RemoveStop and RemoveBus name what is dropped.
+    NetworkDelta GetDelta() const;
+
    private:
     json::Document document_;
 
+    json::Document LoadStatRequests(std::istream& input,
+                                    const StatRequestVisitor& visitor) const;
+
+    std::string ParseRegion(const json::Dict& stat_request) const;
+
+    SerializationSettings ParseFileSettings(const std::string& field) const;
+
+    std::vector<SerializationSettings::Path> ParseDeltas(
+        const json::Dict& settings_json) const;
+
     AddStopRequest ParseStop(const json::Dict& stop_properties) const;
 
     AddBusRequest ParseBus(const json::Dict& bus_properties) const;
@@ -136,11 +266,24 @@ class JsonReader {
 
     StatRequest ParseStatRequest(const json::Dict& stat_requests) const;
 
+    StatRequest ParseTypedStatRequest(const std::string& request_type,
+                                      const json::Dict& stat_request) const;
+
+    StatRequest ParseNearbyStops(const json::Dict& stat_request) const;
+
+    StatRequest ParseSuggest(const json::Dict& stat_request) const;
+
     svg::Color ParseColor(const json::Node& color) const;
 
     std::vector<svg::Color> ParseColorPalette(const json::Array& colors) const;
 
     svg::Point ParsePoint(const json::Array& point) const;
+
+    TransportRouter::Engine ParseEngine(const std::string& engine) const;
+
+    // A limit must not be negative, as it would wrap around to no limit.
+    size_t ParseLimit(const json::Dict& settings,
+                      const std::string& field) const;
 };
 
 }  // namespace trc::io
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "dijkstra.h"
+#include "graph.h"
+
+namespace graph {
+
+// Yen's algorithm: loop-free paths between two vertices in order of
+// increasing weight. Every spur search shares one Dijkstra, so the expansion
+// limit bounds the work of a whole request, not of a single search.
+template <typename Weight>
+class KShortestPaths {
+   private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+   public:
+    using RouteInfo = typename Dijkstra<Weight>::RouteInfo;
+
+    struct Result {
+        std::vector<RouteInfo> routes;
+        size_t expanded_vertex_count = 0;
+        bool limit_reached = false;
+    };
+
+    KShortestPaths(const Graph& graph,
+                   size_t expansion_limit = std::numeric_limits<size_t>::max());
+
+    // Starts from shortest_route when the caller already knows it (e.g. from
+    // the all-pairs Router), otherwise searches for it first.
+    Result Find(VertexId from, VertexId to, size_t count,
+                std::optional<RouteInfo> shortest_route = std::nullopt) const;
+
+   private:
+    const Graph& graph_;
+    size_t expansion_limit_;
+
+    Weight ComputeWeight(const std::vector<EdgeId>& edges) const;
+
+    static bool HasPrefix(const std::vector<EdgeId>& edges,
+                          const std::vector<EdgeId>& prefix, size_t length);
+};
+
+template <typename Weight>
+KShortestPaths<Weight>::KShortestPaths(const Graph& graph,
+                                       size_t expansion_limit)
+    : graph_(graph), expansion_limit_(expansion_limit) {}
+
+template <typename Weight>
+typename KShortestPaths<Weight>::Result KShortestPaths<Weight>::Find(
+    VertexId from, VertexId to, size_t count,
+    std::optional<RouteInfo> shortest_route) const {
+    Result result;
+
+    if (count == 0) {
+        return result;
+    }
+
+    Dijkstra<Weight> dijkstra(graph_);
+    dijkstra.SetExpansionLimit(expansion_limit_);
+
+    if (!shortest_route) {
+        shortest_route = dijkstra.BuildRoute(from, to);
+    }
+
+    if (shortest_route) {
+        result.routes.push_back(std::move(*shortest_route));
+    }
+
+    std::vector<RouteInfo> candidates;
+
+    while (!result.routes.empty() && result.routes.size() < count &&
+           !dijkstra.IsLimitReached()) {
+        const std::vector<EdgeId> last_edges = result.routes.back().edges;
+
+        for (size_t spur_index = 0;
+             spur_index < last_edges.size() && !dijkstra.IsLimitReached();
+             ++spur_index) {
+            dijkstra.ClearBans();
+
+            // Edges leaving the spur vertex along already found paths with
+            // the same root must not be taken again.
+            for (const auto& route : result.routes) {
+                if (HasPrefix(route.edges, last_edges, spur_index)) {
+                    dijkstra.BanEdge(route.edges[spur_index]);
+                }
+            }
+
+            // Root path vertices are banned to keep the result loop-free.
+            for (size_t i = 0; i < spur_index; ++i) {
+                dijkstra.BanVertex(graph_.GetEdge(last_edges[i]).from);
+            }
+
+            const VertexId spur_vertex =
+                graph_.GetEdge(last_edges[spur_index]).from;
+
+            auto spur_route = dijkstra.BuildRoute(spur_vertex, to);
+
+            if (!spur_route) {
+                continue;
+            }
+
+            std::vector<EdgeId> edges(last_edges.begin(),
+                                      last_edges.begin() + spur_index);
+            edges.insert(edges.end(), spur_route->edges.begin(),
+                         spur_route->edges.end());
+
+            const bool is_known =
+                std::any_of(candidates.begin(), candidates.end(),
+                            [&edges](const RouteInfo& candidate) {
+                                return candidate.edges == edges;
+                            });
+
+            if (!is_known) {
+                candidates.push_back({ComputeWeight(edges), std::move(edges)});
+            }
+        }
+
+        if (candidates.empty()) {
+            break;
+        }
+
+        auto best = std::min_element(
+            candidates.begin(), candidates.end(),
+            [](const RouteInfo& lhs, const RouteInfo& rhs) {
+                return lhs.weight < rhs.weight;
+            });
+
+        result.routes.push_back(std::move(*best));
+        candidates.erase(best);
+    }
+
+    result.expanded_vertex_count = dijkstra.GetExpandedVertexCount();
+    result.limit_reached = dijkstra.IsLimitReached();
+
+    return result;
+}
+
+template <typename Weight>
+Weight KShortestPaths<Weight>::ComputeWeight(
+    const std::vector<EdgeId>& edges) const {
+    Weight weight{};
+
+    for (const EdgeId edge_id : edges) {
+        weight = weight + graph_.GetEdge(edge_id).weight;
+    }
+
+    return weight;
+}
+
+template <typename Weight>
+bool KShortestPaths<Weight>::HasPrefix(const std::vector<EdgeId>& edges,
+                                       const std::vector<EdgeId>& prefix,
+                                       size_t length) {
+    return edges.size() > length &&
+           std::equal(prefix.begin(), prefix.begin() + length, edges.begin());
+}
+
+}  // namespace graph
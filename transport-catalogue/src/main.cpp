@@ -1,64 +1,321 @@
+#include "delta.h"
 #include "map_renderer.h"
+#include "network.h"
 #include "request_handler.h"
 #include "serialization.h"
+#include "sharded_network.h"
 #include "transport_catalogue.h"
 #include "transport_router.h"
+#include "versioned.h"
 
 using namespace trc;
 
+#include <atomic>
+#include <csignal>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 using namespace std::literals;
 
 void PrintUsage(std::ostream& stream = std::cerr) {
-    stream << "Usage: transport_catalogue [make_base|process_requests]\n"sv;
+    stream << "Usage: transport_catalogue "
+              "[make_base [--stats]|make_delta|compact_base|"
+              "process_requests [--stats]]\n"sv;
 }
 
+// Reads input to its end in large chunks.
+std::string ReadAll(std::istream& input) {
+    std::string text;
+    char chunk[1 << 16];
+
+    while (input.read(chunk, sizeof(chunk)) || input.gcount() > 0) {
+        text.append(chunk, static_cast<size_t>(input.gcount()));
+    }
+
+    return text;
+}
+
+// Allocations the catalogue's arena absorbed against the heap blocks it
+// actually took for them.
+void LogAllocationStats(const TransportCatalogue& catalogue,
+                        std::ostream& log = std::clog) {
+    const auto stats = catalogue.GetAllocationStats();
+
+    log << "catalogue arena: "sv << stats.allocation_count << " allocations ("sv
+        << stats.allocated_bytes / 1024 << " KiB) in "sv << stats.block_count
+        << " heap blocks ("sv << stats.block_bytes / 1024 << " KiB)"sv
+        << std::endl;
+}
+
+// Heap bytes per part of a network, measured from container capacities.
+void PrintMemoryUsage(const memory::MemoryUsage& usage,
+                      std::ostream& out = std::clog) {
+    for (const auto& [name, bytes] : usage.GetParts()) {
+        out << name << ": "sv << bytes << " bytes\n"sv;
+    }
+    out << "total: "sv << usage.GetTotalBytes() << " bytes"sv << std::endl;
+}
+
+// How often Route requests for alternatives ran into the expansion limit.
+void PrintAlternativesStats(std::string_view name,
+                            const TransportRouter::AlternativesStats& stats,
+                            std::ostream& out = std::clog) {
+    out << name << ": "sv << stats.request_count << " requests, "sv
+        << stats.limit_reached_count << " reached the expansion limit, "sv
+        << stats.expanded_vertex_count << " vertices expanded"sv << std::endl;
+}
+
+// Set by SIGINT, which cancels a router build in progress.
+std::atomic<bool> router_build_cancelled{false};
+
+void CancelRouterBuild(int) { router_build_cancelled.store(true); }
+
+// Answers stat requests while the input is still being parsed, writing each
+// response at once. The network is loaded from the settings that precede
+// stat_requests; requests met before any settings wait for the end of input.
+class StatPipeline {
+   public:
+    explicit StatPipeline(bool print_stats) : print_stats_(print_stats) {
+        build_control_.on_progress = graph::MakeProgressPrinter(std::clog);
+        build_control_.cancelled = &router_build_cancelled;
+    }
+
+    void Handle(io::StatRequest&& stat_request, std::string&& region,
+                const io::JsonReader& preceding) {
+        if (!is_started_ && preceding.HasSerializationSettings()) {
+            Start(preceding);
+        }
+
+        if (!is_started_) {
+            waiting_.emplace_back(std::move(stat_request), std::move(region));
+            return;
+        }
+
+        Answer(stat_request, region);
+    }
+
+    void Finish(const io::JsonReader& json_reader) {
+        if (!is_started_) {
+            Start(json_reader);
+        }
+
+        for (const auto& [stat_request, region] : waiting_) {
+            Answer(stat_request, region);
+        }
+        waiting_.clear();
+
+        if (sharded_handler_) {
+            sharded_handler_->Finish();
+        } else {
+            handler_->Finish();
+        }
+
+        if (print_stats_) {
+            PrintRouterStats();
+        }
+    }
+
+   private:
+    bool print_stats_;
+    graph::BuildControl build_control_;
+    bool is_started_ = false;
+    std::vector<std::pair<io::StatRequest, std::string>> waiting_;
+
+    std::unique_ptr<ShardedNetwork> sharded_network_;
+    std::unique_ptr<rh::ShardedStatRequestHandler> sharded_handler_;
+
+    std::unique_ptr<Versioned<Network>> network_;
+    // The batch is answered from one version even if a newer one is
+    // published meanwhile.
+    Versioned<Network>::Snapshot snapshot_;
+    std::unique_ptr<rh::StatRequestHandler> handler_;
+
+    void Start(const io::JsonReader& settings) {
+        is_started_ = true;
+
+        std::signal(SIGINT, CancelRouterBuild);
+        LoadNetwork(settings);
+        std::signal(SIGINT, SIG_DFL);
+    }
+
+    void LoadNetwork(const io::JsonReader& settings) {
+        if (const auto shard_settings = settings.GetShardSettings();
+            !shard_settings.empty()) {
+            sharded_network_ = std::make_unique<ShardedNetwork>(
+                shard_settings, build_control_);
+
+            memory::MemoryUsage usage;
+
+            for (size_t i = 0; i < sharded_network_->GetShardCount(); ++i) {
+                const auto& shard = sharded_network_->GetShard(i);
+
+                if (print_stats_) {
+                    LogAllocationStats(shard.network->GetCatalogue());
+                }
+                usage.Add(shard.region, shard.network->GetMemoryUsage());
+            }
+
+            if (print_stats_) {
+                PrintMemoryUsage(usage);
+            }
+
+            sharded_handler_ = std::make_unique<rh::ShardedStatRequestHandler>(
+                *sharded_network_, std::cout);
+            return;
+        }
+
+        Serializer serializer(settings.GetSerializationSettings());
+
+        auto [transport_catalogue, render_settings, router_settings] =
+            serializer.Load();
+
+        if (print_stats_) {
+            LogAllocationStats(transport_catalogue);
+        }
+
+        network_ = std::make_unique<Versioned<Network>>(
+            std::make_shared<const Network>(1, std::move(transport_catalogue),
+                                            std::move(render_settings),
+                                            router_settings, build_control_));
+        snapshot_ = network_->Acquire();
+
+        if (print_stats_) {
+            PrintMemoryUsage(snapshot_->GetMemoryUsage());
+        }
+
+        handler_ = std::make_unique<rh::StatRequestHandler>(*snapshot_,
+                                                            std::cout);
+    }
+
+    void PrintRouterStats() const {
+        if (!sharded_network_) {
+            PrintAlternativesStats(
+                "alternatives"sv,
+                snapshot_->GetRouter().GetAlternativesStats());
+            return;
+        }
+
+        for (size_t i = 0; i < sharded_network_->GetShardCount(); ++i) {
+            const auto& shard = sharded_network_->GetShard(i);
+
+            PrintAlternativesStats(
+                shard.region + ".alternatives",
+                shard.network->GetRouter().GetAlternativesStats());
+        }
+    }
+
+    void Answer(const io::StatRequest& stat_request,
+                const std::string& region) {
+        if (sharded_handler_) {
+            sharded_handler_->Handle(stat_request, region);
+        } else {
+            handler_->Handle(stat_request);
+        }
+    }
+};
+
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
+    // Unsynchronized, std::cin tells what it has buffered, so requests are
+    // parsed in chunks as they arrive, and std::cout, which it is tied to, is
+    // flushed only before waiting for more.
+    std::ios::sync_with_stdio(false);
+
+    if (argc != 2 && argc != 3) {
         PrintUsage();
         return 1;
     }
 
     const std::string_view mode(argv[1]);
 
+    const bool print_stats = argc == 3;
+    const bool takes_stats =
+        mode == "make_base"sv || mode == "process_requests"sv;
+    if (print_stats && (!takes_stats || argv[2] != "--stats"sv)) {
+        PrintUsage();
+        return 1;
+    }
+
     if (mode == "make_base"sv) {
-        io::JsonReader json_reader(std::cin);
+        const std::string text = ReadAll(std::cin);
+
+        // The text is counted first so that the catalogue, whose arena
+        // never reuses the buffers of a container that grew, is sized once.
+        // Base requests then go into the builder as they are parsed rather
+        // than being held as a whole document.
+        const io::BaseRequestCounts counts = io::CountBaseRequests(text);
+
+        rh::CatalogueBuilder catalogue_builder;
+        catalogue_builder.Reserve(counts.stop_count, counts.bus_count,
+                                  counts.route_stop_count,
+                                  counts.distance_count);
+
+        io::JsonReader json_reader(
+            text,
+            {[&](io::AddStopRequest&& stop) {
+                 catalogue_builder.AddStop(stop);
+             },
+             [&](io::AddBusRequest&& bus) {
+                 catalogue_builder.AddBus(std::move(bus));
+             }});
 
         render::MapRenderer map_renderer(json_reader.GetRenderSettings());
 
         Serializer serializer(json_reader.GetSerializationSettings());
 
-        rh::BaseRequestHandler base_request_handler(json_reader);
+        TransportCatalogue transport_catalogue = catalogue_builder.Build();
 
-        TransportCatalogue transport_catalogue =
-            base_request_handler.BuildTransportCatalogue();
+        if (print_stats) {
+            LogAllocationStats(transport_catalogue);
+        }
 
         TransportRouter::Settings router_settings =
             json_reader.GetRoutingSettings();
 
         serializer.Save(transport_catalogue, map_renderer.GetRenderSettings(),
                         router_settings);
-    } else if (mode == "process_requests"sv) {
+    } else if (mode == "make_delta"sv) {
         io::JsonReader json_reader(std::cin);
 
+        const NetworkDelta delta = json_reader.GetDelta();
+
+        // Applying the delta to the chain it extends rejects references to
+        // unknown stops and buses before anything is written.
         Serializer serializer(json_reader.GetSerializationSettings());
+        ApplyDelta(serializer.Load().trc, delta);
 
-        auto [transport_catalogue, render_settings, router_settings] =
-            serializer.Load();
+        Serializer(json_reader.GetDeltaSettings()).SaveDelta(delta);
+    } else if (mode == "compact_base"sv) {
+        io::JsonReader json_reader(std::cin);
 
-        render::MapRenderer map_renderer(std::move(render_settings));
+        Serializer serializer(json_reader.GetSerializationSettings());
 
-        TransportRouter transport_router(router_settings, transport_catalogue);
+        const auto [transport_catalogue, render_settings, router_settings] =
+            serializer.Load();
 
-        rh::StatRequestHandler stat_request_handler(
-            transport_catalogue, map_renderer, transport_router, json_reader,
-            std::cout);
+        Serializer(json_reader.GetCompactionSettings())
+            .Save(transport_catalogue, render_settings, router_settings);
+    } else if (mode == "process_requests"sv) {
+        StatPipeline pipeline(print_stats);
 
-        stat_request_handler.HandleStatRequests();
+        try {
+            const io::JsonReader json_reader(
+                std::cin,
+                [&](io::StatRequest&& stat_request, std::string&& region,
+                    const io::JsonReader& preceding) {
+                    pipeline.Handle(std::move(stat_request), std::move(region),
+                                    preceding);
+                });
 
+            pipeline.Finish(json_reader);
+        } catch (const graph::BuildCancelled& error) {
+            std::cerr << error.what() << std::endl;
+            return 2;
+        }
     } else {
         PrintUsage();
         return 1;
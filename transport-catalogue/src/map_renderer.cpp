@@ -1,6 +1,7 @@
 #include "map_renderer.h"
 
 #include <ostream>
+#include <variant>
 
 #include "svg.h"
 
@@ -38,91 +39,130 @@ svg::Point SphereProjector::operator()(geo::Coordinates coords) const {
 }
 
 MapRenderer::MapRenderer(RenderSettings&& settings)
-    : settings_(std::move(settings)), current_color_(0) {}
+    : settings_(std::move(settings)) {}
 
-void MapRenderer::Render(const std::deque<Bus>& buses, std::ostream& out) {
-    const std::set<Bus> sorted_buses(buses.begin(), buses.end());
+void MapRenderer::Render(const TransportCatalogue& catalogue,
+                         std::ostream& out) const {
+    const auto& buses = catalogue.GetBuses();
 
-    auto [min_lat, max_lat, min_lng, max_lng] = MinMaxLatLng(sorted_buses);
+    std::vector<const Bus*> sorted_buses;
+    sorted_buses.reserve(buses.size());
+
+    for (const Bus& bus : buses) {
+        sorted_buses.push_back(&bus);
+    }
+
+    std::sort(sorted_buses.begin(), sorted_buses.end(),
+              [](const Bus* lhs, const Bus* rhs) { return *lhs < *rhs; });
+
+    auto [min_lat, max_lat, min_lng, max_lng] =
+        MinMaxLatLng(catalogue, sorted_buses);
 
     SphereProjector projector_(min_lat, max_lat, min_lng, max_lng,
                                settings_.width, settings_.height,
                                settings_.padding);
 
-    for (const auto& bus : sorted_buses) {
-        if (bus.route.empty()) {
+    svg::Document document;
+    size_t current_color = 0;
+
+    for (const Bus* bus : sorted_buses) {
+        const RouteView route = catalogue.GetRoute(*bus);
+
+        if (route.empty()) {
             continue;
         }
 
-        RouteLine(bus.route, projector_,
-                  settings_.color_palette[current_color_], settings_.line_width,
+        RouteLine(route, projector_, settings_.color_palette[current_color],
+                  settings_.line_width,
                   svg::StrokeLineCap::ROUND, svg::StrokeLineJoin::ROUND,
                   std::monostate{})
-            .Draw(document_);
+            .Draw(document);
 
-        current_color_ = (current_color_ == settings_.color_palette.size() - 1)
-                             ? 0
-                             : current_color_ + 1;
+        current_color = (current_color == settings_.color_palette.size() - 1)
+                            ? 0
+                            : current_color + 1;
     }
 
-    current_color_ = 0;
+    current_color = 0;
 
-    for (const auto& bus : sorted_buses) {
-        if (bus.route.empty()) {
+    for (const Bus* bus : sorted_buses) {
+        const RouteView route = catalogue.GetRoute(*bus);
+
+        if (route.empty()) {
             continue;
         }
 
-        RouteName(bus.route, projector_, bus.name, bus.is_roundtrip,
+        RouteName(route, projector_, bus->name, bus->is_roundtrip,
                   settings_.bus_label_offset, settings_.bus_label_font_size,
                   DEFAULT_FONT, DEFAULT_FONT_WEIGHT,
-                  settings_.color_palette[current_color_],
+                  settings_.color_palette[current_color],
                   settings_.underlayer_color, settings_.underlayer_width,
                   svg::StrokeLineCap::ROUND, svg::StrokeLineJoin::ROUND)
-            .Draw(document_);
-        current_color_ = (current_color_ == settings_.color_palette.size() - 1)
-                             ? 0
-                             : current_color_ + 1;
+            .Draw(document);
+        current_color = (current_color == settings_.color_palette.size() - 1)
+                            ? 0
+                            : current_color + 1;
     }
 
-    current_color_ = 0;
-
     std::set<const Stop*, StopPtrCompare> stops;
 
-    for (const auto& bus : sorted_buses) {
-        for (const Stop* stop : bus.route) {
+    for (const Bus* bus : sorted_buses) {
+        for (const Stop* stop : catalogue.GetRoute(*bus)) {
             stops.insert(stop);
         }
     }
 
     RouteStops(stops, projector_, settings_.stop_radius,
                DEFAULT_FILL_COLOR_STOP)
-        .Draw(document_);
+        .Draw(document);
 
     RouteStopNames(stops, projector_, settings_.stop_label_offset,
                    settings_.stop_label_font_size, DEFAULT_FONT,
                    DEFAULT_FILL_COLOR_STOP_NAME, settings_.underlayer_color,
                    settings_.underlayer_width, svg::StrokeLineCap::ROUND,
                    svg::StrokeLineJoin::ROUND)
-        .Draw(document_);
+        .Draw(document);
 
-    document_.Render(out);
+    document.Render(out);
 }
 
 const RenderSettings& MapRenderer::GetRenderSettings() const {
     return settings_;
 }
 
+memory::MemoryUsage MapRenderer::GetMemoryUsage() const {
+    const auto color_bytes = [](const svg::Color& color) -> size_t {
+        if (const auto* name = std::get_if<std::string>(&color)) {
+            return memory::GetCapacityBytes(*name);
+        }
+        return 0;
+    };
+
+    size_t palette = memory::GetCapacityBytes(settings_.color_palette);
+    for (const svg::Color& color : settings_.color_palette) {
+        palette += color_bytes(color);
+    }
+
+    memory::MemoryUsage usage;
+    usage.Add("color_palette", palette);
+    usage.Add("underlayer_color", color_bytes(settings_.underlayer_color));
+    return usage;
+}
+
 std::tuple<double, double, double, double> MapRenderer::MinMaxLatLng(
-    const std::set<Bus>& buses) const {
+    const TransportCatalogue& catalogue,
+    const std::vector<const Bus*>& buses) const {
     double min_lat{}, max_lat{}, min_lng{}, max_lng{};
 
     bool point_exist = false;
-    for (const auto& bus : buses) {
-        if (!bus.route.empty()) {
-            min_lat = bus.route[0]->coordinates.lat;
-            max_lat = bus.route[0]->coordinates.lat;
-            min_lng = bus.route[0]->coordinates.lng;
-            max_lng = bus.route[0]->coordinates.lng;
+    for (const Bus* bus : buses) {
+        const RouteView route = catalogue.GetRoute(*bus);
+
+        if (!route.empty()) {
+            min_lat = route[0]->coordinates.lat;
+            max_lat = route[0]->coordinates.lat;
+            min_lng = route[0]->coordinates.lng;
+            max_lng = route[0]->coordinates.lng;
             point_exist = true;
             break;
         }
@@ -132,8 +172,8 @@ std::tuple<double, double, double, double> MapRenderer::MinMaxLatLng(
         return {min_lat, max_lat, min_lng, max_lng};
     }
 
-    for (const auto& bus : buses) {
-        for (const auto& stop : bus.route) {
+    for (const Bus* bus : buses) {
+        for (const Stop* stop : catalogue.GetRoute(*bus)) {
             if (stop->coordinates.lat < min_lat) {
                 min_lat = stop->coordinates.lat;
             }
@@ -155,13 +195,12 @@ std::tuple<double, double, double, double> MapRenderer::MinMaxLatLng(
     return {min_lat, max_lat, min_lng, max_lng};
 }
 
-RouteCore::RouteCore(const std::vector<const Stop*>& route,
-                     const SphereProjector& projector)
+RouteCore::RouteCore(RouteView route, const SphereProjector& projector)
     : route(route), projector(projector) {}
 
-RouteLine::RouteLine(const std::vector<const Stop*>& route,
-                     const SphereProjector& projector, svg::Color stroke_color,
-                     double stroke_width, svg::StrokeLineCap stroke_line_cap,
+RouteLine::RouteLine(RouteView route, const SphereProjector& projector,
+                     svg::Color stroke_color, double stroke_width,
+                     svg::StrokeLineCap stroke_line_cap,
                      svg::StrokeLineJoin stroke_line_join,
                      svg::Color fill_color)
     : core_(route, projector),
@@ -200,9 +239,9 @@ RouteTextObjectProperties::RouteTextObjectProperties(
       stroke_line_join(stroke_line_join) {}
 
 std::tuple<svg::Text, svg::Text> PreBuildUnderLayerAndName(
-    const std::string& name, const RouteTextObjectProperties& text_properties) {
+    std::string_view name, const RouteTextObjectProperties& text_properties) {
     return {svg::Text()
-                .SetData(name)
+                .SetData(std::string(name))
                 .SetOffset(text_properties.offset)
                 .SetFontSize(text_properties.font_size)
                 .SetFontFamily(text_properties.font_family)
@@ -212,18 +251,18 @@ std::tuple<svg::Text, svg::Text> PreBuildUnderLayerAndName(
                 .SetStrokeLineCap(text_properties.stroke_line_cap)
                 .SetStrokeLineJoin(text_properties.stroke_line_join),
             svg::Text()
-                .SetData(name)
+                .SetData(std::string(name))
                 .SetOffset(text_properties.offset)
                 .SetFontSize(text_properties.font_size)
                 .SetFontFamily(text_properties.font_family)
                 .SetFillColor(text_properties.font_color)};
 }
 
-RouteName::RouteName(const std::vector<const Stop*>& route,
-                     const SphereProjector& projector, const std::string& name,
-                     bool is_roundtrip, svg::Point bus_label_offset,
-                     int bus_label_font_size, std::string font_family,
-                     std::string font_weight, svg::Color font_color,
+RouteName::RouteName(RouteView route, const SphereProjector& projector,
+                     std::string_view name, bool is_roundtrip,
+                     svg::Point bus_label_offset, int bus_label_font_size,
+                     std::string font_family, std::string font_weight,
+                     svg::Color font_color,
                      svg::Color underlayer_color, double underlayer_width,
                      svg::StrokeLineCap stroke_line_cap,
                      svg::StrokeLineJoin stroke_line_join)
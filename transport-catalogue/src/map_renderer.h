@@ -5,11 +5,14 @@
 #include <iostream>
 #include <optional>
 #include <set>
+#include <string_view>
 #include <vector>
 
 #include "domain.h"
 #include "geo.h"
+#include "memory_usage.h"
 #include "svg.h"
+#include "transport_catalogue.h"
 
 namespace trc::render {
 
@@ -52,32 +55,34 @@ class MapRenderer {
    public:
     explicit MapRenderer(RenderSettings&& settings);
 
-    void Render(const std::deque<Bus>& buses, std::ostream& out);
+    // Keeps no state between calls, so a shared renderer may draw from
+    // several threads at once.
+    void Render(const TransportCatalogue& catalogue, std::ostream& out) const;
 
     const RenderSettings& GetRenderSettings() const;
 
+    // Only the settings persist; documents are built per Render call.
+    memory::MemoryUsage GetMemoryUsage() const;
+
    private:
     RenderSettings settings_;
-    size_t current_color_;
-    svg::Document document_;
 
-    void RenderRoute(const std::vector<const Stop*>& route) const;
     std::tuple<double, double, double, double> MinMaxLatLng(
-        const std::set<Bus>& buses) const;
+        const TransportCatalogue& catalogue,
+        const std::vector<const Bus*>& buses) const;
 };
 
 struct RouteCore {
-    RouteCore(const std::vector<const Stop*>& route,
-              const SphereProjector& projector);
-    const std::vector<const Stop*>& route;
+    RouteCore(RouteView route, const SphereProjector& projector);
+    RouteView route;
     const SphereProjector& projector;
 };
 
 class RouteLine : public svg::Drawable {
    public:
-    RouteLine(const std::vector<const Stop*>& route,
-              const SphereProjector& projector, svg::Color stroke_color,
-              double stroke_width, svg::StrokeLineCap stroke_line_cap,
+    RouteLine(RouteView route, const SphereProjector& projector,
+              svg::Color stroke_color, double stroke_width,
+              svg::StrokeLineCap stroke_line_cap,
               svg::StrokeLineJoin stroke_line_join, svg::Color fill);
     void Draw(svg::ObjectContainer& container) const override;
 
@@ -112,11 +117,11 @@ inline const std::string DEFAULT_FONT_WEIGHT = "bold";
 
 class RouteName : public svg::Drawable {
    public:
-    RouteName(const std::vector<const Stop*>& route,
-              const SphereProjector& projector, const std::string& name,
-              bool is_roundtrip, svg::Point bus_label_offset,
-              int bus_label_font_size, std::string font_family,
-              std::string font_weight, svg::Color font_color_,
+    RouteName(RouteView route, const SphereProjector& projector,
+              std::string_view name, bool is_roundtrip,
+              svg::Point bus_label_offset, int bus_label_font_size,
+              std::string font_family, std::string font_weight,
+              svg::Color font_color_,
               svg::Color underlayer_color, double underlayer_width,
               svg::StrokeLineCap stroke_line_cap,
               svg::StrokeLineJoin stroke_line_join);
@@ -125,7 +130,7 @@ class RouteName : public svg::Drawable {
 
    private:
     RouteCore core_;
-    const std::string& name_;
+    std::string_view name_;
     bool is_roundtrip_;
     RouteTextObjectProperties text_properties_;
     std::string font_weight_;
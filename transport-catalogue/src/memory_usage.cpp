@@ -0,0 +1,29 @@
+#include "memory_usage.h"
+
+#include <utility>
+
+namespace memory {
+
+void MemoryUsage::Add(std::string name, size_t bytes) {
+    parts_.push_back({std::move(name), bytes});
+}
+
+void MemoryUsage::Add(const std::string& prefix, const MemoryUsage& other) {
+    for (const auto& [name, bytes] : other.parts_) {
+        parts_.push_back({prefix + '.' + name, bytes});
+    }
+}
+
+const std::vector<MemoryUsage::Part>& MemoryUsage::GetParts() const {
+    return parts_;
+}
+
+size_t MemoryUsage::GetTotalBytes() const {
+    size_t total = 0;
+    for (const auto& part : parts_) {
+        total += part.bytes;
+    }
+    return total;
+}
+
+}  // namespace memory
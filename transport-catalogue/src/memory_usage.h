@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace memory {
+
+// Heap bytes held by the named parts of a structure. Parts are measured by
+// capacity rather than by element count, so that slack left by growth
+// shows up as well.
+class MemoryUsage {
+   public:
+    struct Part {
+        std::string name;
+        size_t bytes;
+    };
+
+    void Add(std::string name, size_t bytes);
+
+    // Adds the parts of other as "prefix.name".
+    void Add(const std::string& prefix, const MemoryUsage& other);
+
+    const std::vector<Part>& GetParts() const;
+
+    size_t GetTotalBytes() const;
+
+   private:
+    std::vector<Part> parts_;
+};
+
+template <typename T, typename Allocator>
+size_t GetCapacityBytes(const std::vector<T, Allocator>& values) {
+    return values.capacity() * sizeof(T);
+}
+
+// Counts nothing for strings short enough to be stored inline.
+template <typename Char, typename Traits, typename Allocator>
+size_t GetCapacityBytes(
+    const std::basic_string<Char, Traits, Allocator>& string) {
+    const auto* begin = reinterpret_cast<const char*>(&string);
+    const auto* data = reinterpret_cast<const char*>(string.data());
+
+    if (data >= begin && data < begin + sizeof(string)) {
+        return 0;
+    }
+
+    return (string.capacity() + 1) * sizeof(Char);
+}
+
+// Hash tables have no spare capacity for nodes, so these are counted per
+// element: the value plus the next pointer and cached hash of a node.
+template <typename Key, typename Value, typename Hash, typename Equal,
+          typename Allocator>
+size_t GetCapacityBytes(
+    const std::unordered_map<Key, Value, Hash, Equal, Allocator>& map) {
+    using Map = std::unordered_map<Key, Value, Hash, Equal, Allocator>;
+
+    return map.bucket_count() * sizeof(void*) +
+           map.size() * (sizeof(typename Map::value_type) + 2 * sizeof(void*));
+}
+
+}  // namespace memory
@@ -0,0 +1,40 @@
+#include "network.h"
+
+namespace trc {
+
+Network::Network(uint64_t version, TransportCatalogue&& catalogue,
+                 render::RenderSettings&& render_settings,
+                 const TransportRouter::Settings& router_settings,
+                 const graph::BuildControl& build_control)
+    : version_(version),
+      catalogue_(std::move(catalogue)),
+      renderer_(std::move(render_settings)),
+      router_(router_settings, catalogue_.Get(), build_control) {}
+
+uint64_t Network::GetVersion() const { return version_; }
+
+const TransportCatalogue& Network::GetCatalogue() const {
+    return catalogue_.Get();
+}
+
+const PrefixIndex& Network::GetStopNames() const {
+    return catalogue_.GetStopNames();
+}
+
+const PrefixIndex& Network::GetBusNames() const {
+    return catalogue_.GetBusNames();
+}
+
+const render::MapRenderer& Network::GetRenderer() const { return renderer_; }
+
+const TransportRouter& Network::GetRouter() const { return router_; }
+
+memory::MemoryUsage Network::GetMemoryUsage() const {
+    memory::MemoryUsage usage;
+    usage.Add("catalogue", catalogue_.GetMemoryUsage());
+    usage.Add("router", router_.GetMemoryUsage());
+    usage.Add("renderer", renderer_.GetMemoryUsage());
+    return usage;
+}
+
+}  // namespace trc
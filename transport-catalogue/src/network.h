@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+#include "frozen_catalogue.h"
+#include "map_renderer.h"
+#include "memory_usage.h"
+#include "transport_router.h"
+
+namespace trc {
+
+// One published version of the served network: the frozen catalogue with
+// the router and renderer built over it. Immutable once constructed, so it
+// is shared between readers through Versioned<Network>.
+class Network {
+   public:
+    // Throws graph::BuildCancelled when build_control, or the router's own
+    // max_build_time, aborts the routing precompute.
+    Network(uint64_t version, TransportCatalogue&& catalogue,
+            render::RenderSettings&& render_settings,
+            const TransportRouter::Settings& router_settings,
+            const graph::BuildControl& build_control = {});
+
+    Network(const Network&) = delete;
+    Network& operator=(const Network&) = delete;
+
+    uint64_t GetVersion() const;
+
+    const TransportCatalogue& GetCatalogue() const;
+
+    const PrefixIndex& GetStopNames() const;
+
+    const PrefixIndex& GetBusNames() const;
+
+    const render::MapRenderer& GetRenderer() const;
+
+    const TransportRouter& GetRouter() const;
+
+    memory::MemoryUsage GetMemoryUsage() const;
+
+   private:
+    uint64_t version_;
+    // The router refers to the catalogue, so the declaration order matters.
+    FrozenCatalogue catalogue_;
+    render::MapRenderer renderer_;
+    TransportRouter router_;
+};
+
+}  // namespace trc
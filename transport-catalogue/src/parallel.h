@@ -0,0 +1,43 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace trc {
+
+// Calls action(i) for every i < count, in contiguous chunks of at least
+// min_chunk indices spread over the hardware threads; the calling thread
+// takes the first chunk. Returns once all calls are done and rethrows the
+// exception of the earliest failed chunk.
+template <typename Action>
+void ParallelFor(size_t count, Action action, size_t min_chunk = 64) {
+    const size_t thread_count = std::max<size_t>(
+        1, std::min<size_t>(std::thread::hardware_concurrency(),
+                            (count + min_chunk - 1) / min_chunk));
+    const size_t chunk = (count + thread_count - 1) / thread_count;
+
+    const auto run = [&action](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            action(i);
+        }
+    };
+
+    std::vector<std::future<void>> chunks;
+    chunks.reserve(thread_count);
+
+    for (size_t begin = chunk; begin < count; begin += chunk) {
+        chunks.push_back(std::async(std::launch::async, run, begin,
+                                    std::min(begin + chunk, count)));
+    }
+
+    run(0, std::min(chunk, count));
+
+    for (auto& future : chunks) {
+        future.get();
+    }
+}
+
+}  // namespace trc
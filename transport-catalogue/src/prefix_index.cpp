@@ -0,0 +1,136 @@
+#include "prefix_index.h"
+
+#include <algorithm>
+#include <queue>
+
+namespace trc {
+
+using namespace std;
+
+PrefixIndex::PrefixIndex(vector<Entry> entries) : entries_(move(entries)) {
+    sort(entries_.begin(), entries_.end(),
+         [](const Entry& lhs, const Entry& rhs) {
+             return lhs.name < rhs.name;
+         });
+
+    const size_t size = entries_.size();
+    heaviest_.resize(2 * size);
+
+    for (size_t i = 0; i < size; ++i) {
+        heaviest_[size + i] = static_cast<uint32_t>(i);
+    }
+    for (size_t node = size; node-- > 1;) {
+        heaviest_[node] =
+            Heavier(heaviest_[2 * node], heaviest_[2 * node + 1]);
+    }
+}
+
+vector<PrefixIndex::Entry> PrefixIndex::Find(string_view prefix,
+                                             size_t count) const {
+    const auto [begin, end] = FindRange(prefix);
+
+    return {entries_.begin() + begin,
+            entries_.begin() + begin + min(count, end - begin)};
+}
+
+vector<PrefixIndex::Entry> PrefixIndex::FindHeaviest(string_view prefix,
+                                                     size_t count) const {
+    const auto [begin, end] = FindRange(prefix);
+
+    vector<Entry> found;
+    if (begin == end || count == 0) {
+        return found;
+    }
+    found.reserve(min(count, end - begin));
+
+    // Ranges still to be taken from, keyed by their heaviest position.
+    struct Candidate {
+        uint32_t heaviest;
+        size_t begin;
+        size_t end;
+    };
+
+    const auto is_lighter = [this](const Candidate& lhs,
+                                   const Candidate& rhs) {
+        return Heavier(lhs.heaviest, rhs.heaviest) == rhs.heaviest;
+    };
+
+    priority_queue<Candidate, vector<Candidate>, decltype(is_lighter)>
+        candidates(is_lighter);
+    candidates.push({FindHeaviestIn(begin, end), begin, end});
+
+    while (!candidates.empty() && found.size() < count) {
+        const Candidate candidate = candidates.top();
+        candidates.pop();
+
+        found.push_back(entries_[candidate.heaviest]);
+
+        if (candidate.begin < candidate.heaviest) {
+            candidates.push(
+                {FindHeaviestIn(candidate.begin, candidate.heaviest),
+                 candidate.begin, candidate.heaviest});
+        }
+        if (candidate.heaviest + 1 < candidate.end) {
+            candidates.push(
+                {FindHeaviestIn(candidate.heaviest + 1, candidate.end),
+                 candidate.heaviest + 1u, candidate.end});
+        }
+    }
+
+    return found;
+}
+
+size_t PrefixIndex::GetSize() const { return entries_.size(); }
+
+memory::MemoryUsage PrefixIndex::GetMemoryUsage() const {
+    memory::MemoryUsage usage;
+    usage.Add("entries", memory::GetCapacityBytes(entries_));
+    usage.Add("heaviest", memory::GetCapacityBytes(heaviest_));
+    return usage;
+}
+
+pair<size_t, size_t> PrefixIndex::FindRange(string_view prefix) const {
+    const auto begin =
+        lower_bound(entries_.begin(), entries_.end(), prefix,
+                    [](const Entry& entry, string_view name) {
+                        return entry.name < name;
+                    });
+
+    // Names starting with prefix compare equal to it once cut to its size.
+    const auto end =
+        upper_bound(begin, entries_.end(), prefix,
+                    [](string_view name, const Entry& entry) {
+                        return name < entry.name.substr(0, name.size());
+                    });
+
+    return {static_cast<size_t>(begin - entries_.begin()),
+            static_cast<size_t>(end - entries_.begin())};
+}
+
+uint32_t PrefixIndex::Heavier(uint32_t lhs, uint32_t rhs) const {
+    const uint32_t lhs_weight = entries_[lhs].weight;
+    const uint32_t rhs_weight = entries_[rhs].weight;
+
+    if (lhs_weight != rhs_weight) {
+        return lhs_weight > rhs_weight ? lhs : rhs;
+    }
+    return min(lhs, rhs);
+}
+
+uint32_t PrefixIndex::FindHeaviestIn(size_t begin, size_t end) const {
+    const size_t size = entries_.size();
+    uint32_t result = static_cast<uint32_t>(begin);
+
+    for (begin += size, end += size; begin < end; begin /= 2, end /= 2) {
+        if (begin % 2 == 1) {
+            result = Heavier(result, heaviest_[begin++]);
+        }
+        if (end % 2 == 1) {
+            result = Heavier(result, heaviest_[--end]);
+        }
+    }
+
+    return result;
+}
+
+}  // namespace trc
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "memory_usage.h"
+
+namespace trc {
+
+// Immutable autocomplete index: names sorted once, so the names sharing a
+// prefix form one contiguous range found by two binary searches. A segment
+// tree over the weights finds the heaviest name of any range in O(log n),
+// so the top count names by weight are taken without scanning the range.
+// Names are views and must outlive the index.
+class PrefixIndex {
+   public:
+    struct Entry {
+        std::string_view name;
+        uint32_t weight;
+    };
+
+    PrefixIndex() = default;
+
+    explicit PrefixIndex(std::vector<Entry> entries);
+
+    // At most count entries whose names start with prefix, in lexicographic
+    // order.
+    std::vector<Entry> Find(std::string_view prefix, size_t count) const;
+
+    // At most count entries whose names start with prefix, heaviest first;
+    // entries of equal weight in lexicographic order.
+    std::vector<Entry> FindHeaviest(std::string_view prefix,
+                                    size_t count) const;
+
+    size_t GetSize() const;
+
+    memory::MemoryUsage GetMemoryUsage() const;
+
+   private:
+    std::vector<Entry> entries_;
+    // Bottom-up segment tree of entry positions: leaves at [size, 2 size),
+    // each inner node holding the heavier of its two children.
+    std::vector<uint32_t> heaviest_;
+
+    std::pair<size_t, size_t> FindRange(std::string_view prefix) const;
+
+    // Heaviest of the two positions; the earlier one on a tie.
+    uint32_t Heavier(uint32_t lhs, uint32_t rhs) const;
+
+    // Position of the heaviest entry in the non-empty range [begin, end).
+    uint32_t FindHeaviestIn(size_t begin, size_t end) const;
+};
+
+}  // namespace trc
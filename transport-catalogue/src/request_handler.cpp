@@ -1,98 +1,367 @@
 #include "request_handler.h"
 
+#include <algorithm>
 #include <iterator>
 #include <map>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <variant>
+#include <vector>
 
 #include "json_builder.h"
 #include "map_renderer.h"
+#include "parallel.h"
 #include "transport_catalogue.h"
 
 namespace trc::rh {
 
 using namespace std;
 
+namespace {
+
+// Prints the responses in flight and drops them.
+void WriteResponses(json::Array& responses, json::ArrayPrinter& printer) {
+    for (const auto& response : responses) {
+        printer.Print(response);
+    }
+    responses.clear();
+}
+
+// Suggestions of one network, in the order its index gives them.
+vector<PrefixIndex::Entry> FindSuggestions(
+    const Network& network, const io::GetSuggestRequest& request) {
+    const PrefixIndex& index =
+        request.is_bus ? network.GetBusNames() : network.GetStopNames();
+
+    return request.is_ranked ? index.FindHeaviest(request.prefix, request.count)
+                             : index.Find(request.prefix, request.count);
+}
+
+// Suggestions of several networks put in the order one network holding all
+// of them would give. A name found in several keeps its heaviest weight.
+vector<PrefixIndex::Entry> MergeSuggestions(
+    vector<PrefixIndex::Entry> suggestions,
+    const io::GetSuggestRequest& request) {
+    sort(suggestions.begin(), suggestions.end(),
+         [](const PrefixIndex::Entry& lhs, const PrefixIndex::Entry& rhs) {
+             return lhs.name != rhs.name ? lhs.name < rhs.name
+                                         : lhs.weight > rhs.weight;
+         });
+    suggestions.erase(
+        unique(suggestions.begin(), suggestions.end(),
+               [](const PrefixIndex::Entry& lhs,
+                  const PrefixIndex::Entry& rhs) {
+                   return lhs.name == rhs.name;
+               }),
+        suggestions.end());
+
+    if (request.is_ranked) {
+        stable_sort(
+            suggestions.begin(), suggestions.end(),
+            [](const PrefixIndex::Entry& lhs, const PrefixIndex::Entry& rhs) {
+                return lhs.weight > rhs.weight;
+            });
+    }
+
+    if (suggestions.size() > request.count) {
+        suggestions.resize(request.count);
+    }
+
+    return suggestions;
+}
+
+json::Node BuildSuggestResponse(
+    int id, const vector<PrefixIndex::Entry>& suggestions) {
+    json::Array names;
+    names.reserve(suggestions.size());
+
+    for (const auto& suggestion : suggestions) {
+        names.emplace_back(std::string(suggestion.name));
+    }
+
+    // clang-format off
+    return json::Builder{}
+        .StartDict()
+            .Key(io::NAMES_FIELD).Value(std::move(names))
+            .Key(io::REQUEST_ID_FIELD).Value(id)
+        .EndDict().Build();
+    // clang-format on
+}
+
+}  // namespace
+
+// CatalogueBuilder
+void CatalogueBuilder::Reserve(size_t stop_count, size_t bus_count,
+                               size_t route_stop_count,
+                               size_t distance_count) {
+    catalogue_.Reserve(stop_count, bus_count, route_stop_count,
+                       distance_count);
+    buses_.reserve(bus_count);
+}
+
+void CatalogueBuilder::AddStop(const io::AddStopRequest& stop_request) {
+    Stop stop;
+    stop.name = stop_request.name;
+    stop.coordinates = {stop_request.latitude, stop_request.longitude};
+
+    const StopId from = catalogue_.AddStop(std::move(stop));
+
+    for (const auto& [stop_to, distance] : stop_request.road_distances) {
+        if (const auto to = catalogue_.FindStopId(stop_to)) {
+            catalogue_.AddDistance(from, *to, distance);
+        } else {
+            pending_distances_[stop_to].emplace_back(from, distance);
+        }
+    }
+
+    if (const auto it = pending_distances_.find(stop_request.name);
+        it != pending_distances_.end()) {
+        for (const auto& [stop_from, distance] : it->second) {
+            catalogue_.AddDistance(stop_from, from, distance);
+        }
+        pending_distances_.erase(it);
+    }
+}
+
+void CatalogueBuilder::AddBus(io::AddBusRequest&& bus_request) {
+    ResolveRoute(buses_.emplace_back(PendingBus{std::move(bus_request), {}}));
+}
+
+TransportCatalogue CatalogueBuilder::Build() {
+    if (!pending_distances_.empty()) {
+        const auto& [stop_to, distances] = *pending_distances_.begin();
+        const StopId from = distances.front().first;
+
+        throw invalid_argument("Stop " +
+                               string(catalogue_.GetStops()[from].name) +
+                               " has a distance to unknown stop " + stop_to);
+    }
+
+    // Resolving the remaining names and computing route statistics only
+    // read the catalogue, so that part runs in parallel; insertion stays
+    // serial and in request order, which keeps the ids deterministic.
+    vector<Bus> buses(buses_.size());
+
+    ParallelFor(buses_.size(), [&](size_t i) {
+        PendingBus& bus = buses_[i];
+
+        if (const auto unknown_stop = ResolveRoute(bus)) {
+            throw invalid_argument("Bus " + bus.request.name +
+                                   " stops at unknown stop " +
+                                   string(*unknown_stop));
+        }
+
+        buses[i] = catalogue_.MakeBus(bus.request.name, bus.route,
+                                      bus.request.is_roundtrip);
+    });
+
+    for (size_t i = 0; i < buses.size(); ++i) {
+        catalogue_.AddBus(buses[i], buses_[i].route);
+    }
+    buses_.clear();
+
+    return std::move(catalogue_);
+}
+
+optional<string_view> CatalogueBuilder::ResolveRoute(PendingBus& bus) const {
+    // Names are only kept while unresolved.
+    if (bus.request.stops.empty()) {
+        return nullopt;
+    }
+
+    vector<StopId> route;
+    route.reserve(bus.request.stops.size());
+
+    for (const auto& stop : bus.request.stops) {
+        const auto stop_id = catalogue_.FindStopId(stop);
+
+        if (!stop_id) {
+            return stop;
+        }
+        route.push_back(*stop_id);
+    }
+
+    bus.route = std::move(route);
+    vector<string>().swap(bus.request.stops);
+
+    return nullopt;
+}
+
 // BaseRequestHandler
 BaseRequestHandler::BaseRequestHandler(const io::JsonReader& json_reader)
     : json_reader_(json_reader) {}
 
 TransportCatalogue BaseRequestHandler::BuildTransportCatalogue() {
-    TransportCatalogue transport_catalogue;
+    const vector<io::AddStopRequest> stop_requests = json_reader_.GetStops();
+    vector<io::AddBusRequest> bus_requests = json_reader_.GetBuses();
 
-    AddStops(transport_catalogue);
-    AddBuses(transport_catalogue);
+    size_t route_stop_count = 0;
+    for (const auto& bus_request : bus_requests) {
+        route_stop_count += bus_request.stops.size();
+    }
 
-    return transport_catalogue;
-}
+    size_t distance_count = 0;
+    for (const auto& stop_request : stop_requests) {
+        distance_count += stop_request.road_distances.size();
+    }
 
-void BaseRequestHandler::AddStops(TransportCatalogue& transport_catalogue) {
-    vector<io::AddStopRequest> stop_requests = json_reader_.GetStops();
+    CatalogueBuilder builder;
+    builder.Reserve(stop_requests.size(), bus_requests.size(),
+                    route_stop_count, distance_count);
 
     for (const auto& stop_request : stop_requests) {
-        Stop stop = {stop_request.name,
-                     {stop_request.latitude, stop_request.longitude}};
+        builder.AddStop(stop_request);
+    }
+    for (auto& bus_request : bus_requests) {
+        builder.AddBus(std::move(bus_request));
+    }
+
+    return builder.Build();
+}
+
+// StatRequestHandler
+StatRequestHandler::StatRequestHandler(const Network& network, ostream& output)
+    : stat_handler_(network, responses_), printer_(output) {}
 
-        transport_catalogue.AddStop(std::move(stop));
+void StatRequestHandler::HandleStatRequests(
+    const io::JsonReader& json_reader) {
+    for (const auto& stat_request : json_reader.GetStatRequests()) {
+        Handle(stat_request);
     }
+    Finish();
+}
 
-    for (const auto& stop_request : stop_requests) {
-        const string& stop_from = stop_request.name;
+void StatRequestHandler::Handle(const io::StatRequest& stat_request) {
+    std::visit(stat_handler_, stat_request);
+    WriteResponses(responses_, printer_);
+}
 
-        for (const auto& [stop_to, distance] : stop_request.road_distances) {
-            transport_catalogue.AddDistance(stop_from, stop_to, distance);
-        }
+void StatRequestHandler::Finish() {
+    if (printer_.GetSize() > 0) {
+        printer_.Finish();
     }
 }
 
-void BaseRequestHandler::AddBuses(TransportCatalogue& transport_catalogue) {
-    for (const auto& bus_request : json_reader_.GetBuses()) {
-        transport_catalogue.AddBus(bus_request.name, bus_request.stops,
-                                   bus_request.is_roundtrip);
+// ShardedStatRequestHandler
+ShardedStatRequestHandler::ShardedStatRequestHandler(
+    const ShardedNetwork& network, ostream& output)
+    : network_(network), printer_(output) {
+    stat_handlers_.reserve(network_.GetShardCount());
+
+    for (size_t i = 0; i < network_.GetShardCount(); ++i) {
+        stat_handlers_.emplace_back(*network_.GetShard(i).network, responses_);
     }
 }
 
-// StatRequestHandler
-StatRequestHandler::StatRequestHandler(
-    const TransportCatalogue& transport_catalogue,
-    render::MapRenderer& map_renderer, const TransportRouter& transport_router,
-    const io::JsonReader& json_reader, ostream& output)
-    : transport_catalogue_(transport_catalogue),
-      json_reader_(json_reader),
-      map_renderer_(map_renderer),
-      router_(transport_router),
-      output_(output) {}
+void ShardedStatRequestHandler::HandleStatRequests(
+    const io::JsonReader& json_reader) {
+    const vector<io::StatRequest> stat_requests =
+        json_reader.GetStatRequests();
+    const vector<string> regions = json_reader.GetStatRequestRegions();
 
-void StatRequestHandler::HandleStatRequests() {
-    vector<io::StatRequest> stat_requests = json_reader_.GetStatRequests();
+    for (size_t i = 0; i < stat_requests.size(); ++i) {
+        Handle(stat_requests[i], regions[i]);
+    }
+    Finish();
+}
 
-    StatHandler stat_handler(transport_catalogue_, map_renderer_, router_,
-                             output_);
+void ShardedStatRequestHandler::Handle(const io::StatRequest& stat_request,
+                                       const string& region) {
+    const auto* suggest = std::get_if<io::GetSuggestRequest>(&stat_request);
 
-    for (const auto& stat_request : stat_requests) {
-        std::visit(stat_handler, stat_request);
+    if (suggest && region.empty()) {
+        HandleSuggest(*suggest);
+    } else if (const auto shard = FindShard(stat_request, region)) {
+        std::visit(stat_handlers_[*shard], stat_request);
+    } else {
+        std::visit(
+            [&](const auto& request) {
+                using Request = std::decay_t<decltype(request)>;
+
+                if constexpr (std::is_same_v<Request, io::UnknownRequest> ||
+                              std::is_same_v<Request, io::InvalidRequest>) {
+                    // Answered the same by any shard.
+                    stat_handlers_.front()(request);
+                } else {
+                    stat_handlers_.front().HandleNotFound(request.id);
+                }
+            },
+            stat_request);
     }
 
-    stat_handler.Print();
+    WriteResponses(responses_, printer_);
 }
 
-StatRequestHandler::StatHandler::StatHandler(
-    const TransportCatalogue& transport_catalogue,
-    render::MapRenderer& map_renderer, const TransportRouter& router,
-    std::ostream& output)
-    : transport_catalogue_(transport_catalogue),
-      map_renderer_(map_renderer),
-      router_(router),
-      output_(output) {}
+void ShardedStatRequestHandler::HandleSuggest(
+    const io::GetSuggestRequest& get_suggest_request) {
+    vector<PrefixIndex::Entry> suggestions;
+
+    for (size_t i = 0; i < network_.GetShardCount(); ++i) {
+        const auto shard_suggestions = FindSuggestions(
+            *network_.GetShard(i).network, get_suggest_request);
+        suggestions.insert(suggestions.end(), shard_suggestions.begin(),
+                           shard_suggestions.end());
+    }
+
+    responses_.push_back(BuildSuggestResponse(
+        get_suggest_request.id,
+        MergeSuggestions(move(suggestions), get_suggest_request)));
+}
 
-void StatRequestHandler::StatHandler::operator()(
+void ShardedStatRequestHandler::Finish() {
+    if (printer_.GetSize() > 0) {
+        printer_.Finish();
+    }
+}
+
+optional<size_t> ShardedStatRequestHandler::FindShard(
+    const io::StatRequest& stat_request, const string& region) const {
+    if (!region.empty()) {
+        return network_.FindRegion(region);
+    }
+
+    const string_view name = std::visit(
+        [](const auto& request) -> string_view {
+            using Request = std::decay_t<decltype(request)>;
+
+            if constexpr (std::is_same_v<Request, io::GetStopRequest> ||
+                          std::is_same_v<Request, io::GetBusRequest>) {
+                return request.name;
+            } else if constexpr (std::is_same_v<Request,
+                                                io::GetRouteRequest> ||
+                                 std::is_same_v<Request,
+                                                io::GetIsochroneRequest>) {
+                return request.from_stop;
+            } else {
+                return {};
+            }
+        },
+        stat_request);
+
+    return network_.FindShardByName(name);
+}
+
+// StatHandler
+StatHandler::StatHandler(const Network& network, json::Array& responses)
+    : network_(network),
+      transport_catalogue_(network.GetCatalogue()),
+      map_renderer_(network.GetRenderer()),
+      router_(network.GetRouter()),
+      responses_(responses) {}
+
+void StatHandler::operator()(
     const io::GetStopRequest& get_stop_request) {
-    optional<set<string>> stop_info =
+    const auto stop_info =
         transport_catalogue_.GetStopInfo(get_stop_request.name);
 
     if (stop_info.has_value()) {
-        json::Array buses(std::make_move_iterator(stop_info->begin()),
-                          std::make_move_iterator(stop_info->end()));
+        json::Array buses;
+        for (const std::string_view bus_name : *stop_info) {
+            buses.emplace_back(std::string(bus_name));
+        }
         // clang-format off
         responses_.push_back(
             json::Builder{}
@@ -106,7 +375,7 @@ void StatRequestHandler::StatHandler::operator()(
     }
 }
 
-void StatRequestHandler::StatHandler::operator()(
+void StatHandler::operator()(
     const io::GetBusRequest& get_bus_request) {
     std::optional<TransportCatalogue::BusInfo> bus_info =
         transport_catalogue_.GetBusInfo(get_bus_request.name);
@@ -133,11 +402,11 @@ void StatRequestHandler::StatHandler::operator()(
     }
 }
 
-void StatRequestHandler::StatHandler::operator()(
+void StatHandler::operator()(
     const io::GetMapRequest& get_map_request) {
     ostringstream svg_document;
 
-    map_renderer_.Render(transport_catalogue_.GetBuses(), svg_document);
+    map_renderer_.Render(transport_catalogue_, svg_document);
 
     // clang-format off
     responses_.push_back(
@@ -151,48 +420,180 @@ void StatRequestHandler::StatHandler::operator()(
     // clang-format on
 }
 
-void StatRequestHandler::StatHandler::operator()(
+void StatHandler::operator()(
     const io::GetRouteRequest& get_route_request) {
-    const auto route_info = router_.BuildRoute(get_route_request.from_stop,
-                                               get_route_request.to_stop);
+    const bool wants_alternatives = get_route_request.alternatives > 1;
+
+    // The first alternative is the shortest route, so a single search
+    // serves both.
+    TransportRouter::Alternatives alternatives;
+    std::optional<TransportRouter::RouteInfo> shortest_route;
+    const TransportRouter::RouteInfo* route_info = nullptr;
+
+    if (wants_alternatives) {
+        alternatives = router_.BuildAlternatives(
+            get_route_request.from_stop, get_route_request.to_stop,
+            get_route_request.alternatives);
+        if (!alternatives.routes.empty()) {
+            route_info = &alternatives.routes.front();
+        }
+    } else {
+        shortest_route = router_.BuildRoute(get_route_request.from_stop,
+                                            get_route_request.to_stop);
+        if (shortest_route.has_value()) {
+            route_info = &*shortest_route;
+        }
+    }
 
-    if (route_info.has_value()) {
-        json::Array items;
-        ItemVisitor item_visitor(items);
+    if (route_info == nullptr) {
+        HandleNotFound(get_route_request.id);
+        return;
+    }
 
-        for (const auto& item : route_info->items) {
-            std::visit(item_visitor, item);
-        }
+    json::Builder response;
 
-        // clang-format off
-        responses_.push_back(
-                json::Builder{} 
+    // clang-format off
+    response
+        .StartDict()
+            .Key(io::ITEMS_FIELD)
+                .Value(BuildItems(*route_info))
+            .Key(io::TOTAL_TIME_FIELD)
+                .Value(route_info->total_time)
+            .Key(io::REQUEST_ID_FIELD)
+                .Value(get_route_request.id);
+    // clang-format on
+
+    if (wants_alternatives) {
+        json::Array routes;
+        for (const auto& route : alternatives.routes) {
+            // clang-format off
+            routes.push_back(
+                json::Builder{}
                     .StartDict()
                         .Key(io::ITEMS_FIELD)
-                            .Value(items)
+                            .Value(BuildItems(route))
                         .Key(io::TOTAL_TIME_FIELD)
-                            .Value(route_info->total_time)
-                        .Key(io::REQUEST_ID_FIELD)
-                            .Value(get_route_request.id)
+                            .Value(route.total_time)
                     .EndDict().Build());
-        //clang-format on
+            // clang-format on
+        }
 
-    } else {
-        HandleNotFound(get_route_request.id);
+        // clang-format off
+        response
+            .Key(io::ALTERNATIVES_FIELD)
+                .Value(std::move(routes))
+            .Key(io::ALTERNATIVES_LIMIT_REACHED_FIELD)
+                .Value(alternatives.limit_reached);
+        // clang-format on
     }
+
+    responses_.push_back(response.EndDict().Build());
 }
 
-void StatRequestHandler::StatHandler::operator()(const io::UnknownRequest&) {
-    responses_.push_back("Unknown request");
+void StatHandler::operator()(
+    const io::GetIsochroneRequest& get_isochrone_request) {
+    const auto reachable_stops = router_.FindReachableStops(
+        get_isochrone_request.from_stop, get_isochrone_request.max_time);
+
+    if (!reachable_stops.has_value()) {
+        HandleNotFound(get_isochrone_request.id);
+        return;
+    }
+
+    json::Array stops;
+    stops.reserve(reachable_stops->size());
+
+    for (const auto& reachable_stop : *reachable_stops) {
+        // clang-format off
+        stops.push_back(
+            json::Builder{}
+                .StartDict()
+                    .Key(io::STOP_NAME_FIELD)
+                        .Value(std::string(reachable_stop.stop_name))
+                    .Key(io::TIME_FIELD)
+                        .Value(reachable_stop.time)
+                .EndDict().Build());
+        // clang-format on
+    }
+
+    // clang-format off
+    responses_.push_back(
+        json::Builder{}
+            .StartDict()
+                .Key(io::STOPS_FIELD)
+                    .Value(std::move(stops))
+                .Key(io::REQUEST_ID_FIELD)
+                    .Value(get_isochrone_request.id)
+            .EndDict().Build());
+    // clang-format on
 }
 
-void StatRequestHandler::StatHandler::Print() {
-    if (!responses_.empty()) {
-        json::Print(json::Document{responses_}, output_);
+void StatHandler::operator()(
+    const io::GetNearbyStopsRequest& get_nearby_stops_request) {
+    const auto& [id, coordinates, count, radius] = get_nearby_stops_request;
+
+    vector<StopGrid::NearbyStop> nearby_stops =
+        radius ? transport_catalogue_.FindStopsWithin(coordinates, *radius)
+               : transport_catalogue_.FindNearestStops(coordinates, *count);
+
+    if (count && nearby_stops.size() > *count) {
+        nearby_stops.resize(*count);
+    }
+
+    const auto& all_stops = transport_catalogue_.GetStops();
+
+    json::Array stops;
+    stops.reserve(nearby_stops.size());
+
+    for (const auto& nearby_stop : nearby_stops) {
+        // clang-format off
+        stops.push_back(
+            json::Builder{}
+                .StartDict()
+                    .Key(io::STOP_NAME_FIELD)
+                        .Value(std::string(all_stops[nearby_stop.id].name))
+                    .Key(io::DISTANCE_FIELD)
+                        .Value(nearby_stop.distance)
+                .EndDict().Build());
+        // clang-format on
     }
+
+    // clang-format off
+    responses_.push_back(
+        json::Builder{}
+            .StartDict()
+                .Key(io::STOPS_FIELD)
+                    .Value(std::move(stops))
+                .Key(io::REQUEST_ID_FIELD)
+                    .Value(id)
+            .EndDict().Build());
+    // clang-format on
+}
+
+void StatHandler::operator()(const io::GetSuggestRequest& get_suggest_request) {
+    responses_.push_back(
+        BuildSuggestResponse(get_suggest_request.id,
+                             FindSuggestions(network_, get_suggest_request)));
+}
+
+void StatHandler::operator()(const io::InvalidRequest& invalid_request) {
+    // clang-format off
+    responses_.push_back(
+        json::Builder{}
+            .StartDict()
+                .Key(io::REQUEST_ID_FIELD)
+                    .Value(invalid_request.id)
+                .Key(io::ERROR_MESSAGE_FIELD)
+                    .Value(invalid_request.error_message)
+            .EndDict().Build());
+    // clang-format on
+}
+
+void StatHandler::operator()(const io::UnknownRequest&) {
+    responses_.push_back("Unknown request");
 }
 
-void StatRequestHandler::StatHandler::HandleNotFound(int id) {
+void StatHandler::HandleNotFound(int id) {
     // clang-format off
     responses_.push_back(
             json::Builder{}
@@ -205,10 +606,22 @@ void StatRequestHandler::StatHandler::HandleNotFound(int id) {
     // clang-format on
 }
 
-StatRequestHandler::StatHandler::ItemVisitor::ItemVisitor(json::Array& items)
+json::Array StatHandler::BuildItems(
+    const TransportRouter::RouteInfo& route) {
+    json::Array items;
+    ItemVisitor item_visitor(items);
+
+    for (const auto& item : route.items) {
+        std::visit(item_visitor, item);
+    }
+
+    return items;
+}
+
+StatHandler::ItemVisitor::ItemVisitor(json::Array& items)
     : items_(items) {}
 
-void StatRequestHandler::StatHandler::ItemVisitor::operator()(
+void StatHandler::ItemVisitor::operator()(
     const TransportRouter::WaitItem& wait_item) {
     // clang-format off
     items_.push_back(
@@ -224,7 +637,7 @@ void StatRequestHandler::StatHandler::ItemVisitor::operator()(
     // clang-format on
 }
 
-void StatRequestHandler::StatHandler::ItemVisitor::operator()(
+void StatHandler::ItemVisitor::operator()(
     const TransportRouter::BusItem& bus_item) {
     // clang-format off
     items_.push_back(
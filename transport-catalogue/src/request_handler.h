@@ -1,14 +1,55 @@
 #pragma once
 
+#include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "json_reader.h"
+#include "sharded_network.h"
 #include "transport_catalogue.h"
 #include "transport_router.h"
 
 namespace trc::rh {
 
+// Builds a catalogue from base requests fed one at a time, in whatever order
+// stops and buses come. Stops are interned at once; a road distance to a
+// stop not seen yet waits for that stop. Buses keep only their resolved
+// route until Build, which computes their statistics in parallel and adds
+// them in request order, so ids do not depend on how the input was read.
+class CatalogueBuilder {
+   public:
+    void Reserve(size_t stop_count, size_t bus_count, size_t route_stop_count,
+                 size_t distance_count);
+
+    void AddStop(const io::AddStopRequest& stop_request);
+
+    void AddBus(io::AddBusRequest&& bus_request);
+
+    // Throws std::invalid_argument when a distance or a bus refers to a stop
+    // that never came. The builder is not to be used afterwards.
+    TransportCatalogue Build();
+
+   private:
+    struct PendingBus {
+        // Stop names are dropped once they all resolve into route.
+        io::AddBusRequest request;
+        std::vector<StopId> route;
+    };
+
+    TransportCatalogue catalogue_;
+    std::unordered_map<std::string, std::vector<std::pair<StopId, double>>>
+        pending_distances_;
+    std::vector<PendingBus> buses_;
+
+    // Fills the route and drops the names unless a stop is not known yet;
+    // returns the first such stop.
+    std::optional<std::string_view> ResolveRoute(PendingBus& bus) const;
+};
+
 class BaseRequestHandler {
    public:
     BaseRequestHandler(const io::JsonReader& json_reader);
@@ -17,66 +58,109 @@ class BaseRequestHandler {
 
    private:
     const io::JsonReader& json_reader_;
-
-    void AddStops(TransportCatalogue& transport_catalogue);
-
-    void AddBuses(TransportCatalogue& transport_catalogue);
 };
 
-class StatRequestHandler {
+// Answers stat requests from one network, appending to a shared array.
+class StatHandler {
    public:
-    StatRequestHandler(const TransportCatalogue& transport_catalogue,
-                       render::MapRenderer& map_renderer_,
-                       const TransportRouter& transport_router,
-                       const io::JsonReader& json_reader, std::ostream& output);
+    StatHandler(const Network& network, json::Array& responses);
+
+    void operator()(const io::GetStopRequest&);
+
+    void operator()(const io::GetBusRequest&);
+
+    void operator()(const io::GetMapRequest&);
+
+    void operator()(const io::GetRouteRequest&);
+
+    void operator()(const io::GetIsochroneRequest&);
+
+    void operator()(const io::GetNearbyStopsRequest&);
+
+    void operator()(const io::GetSuggestRequest&);
 
-    void HandleStatRequests();
+    void operator()(const io::InvalidRequest&);
+
+    void operator()(const io::UnknownRequest&);
+
+    void HandleNotFound(int id);
 
    private:
+    const Network& network_;
     const TransportCatalogue& transport_catalogue_;
-    const io::JsonReader& json_reader_;
-    render::MapRenderer& map_renderer_;
+    const render::MapRenderer& map_renderer_;
     const TransportRouter& router_;
-    std::ostream& output_;
+    json::Array& responses_;
 
-    class StatHandler {
-       public:
-        StatHandler(const TransportCatalogue& transport_catalogue,
-                    render::MapRenderer& map_renderer,
-                    const TransportRouter& router_, std::ostream& output);
+    static json::Array BuildItems(const TransportRouter::RouteInfo& route);
 
-        void operator()(const io::GetStopRequest&);
+    struct ItemVisitor {
+        ItemVisitor(json::Array& items);
 
-        void operator()(const io::GetBusRequest&);
+        void operator()(const TransportRouter::WaitItem&);
 
-        void operator()(const io::GetMapRequest&);
+        void operator()(const TransportRouter::BusItem&);
+
+       private:
+        json::Array& items_;
+    };
+};
 
-        void operator()(const io::GetRouteRequest&);
+// Writes each response as soon as its request is answered, so responses
+// are never held beyond the one in flight; the output is laid out exactly
+// as if the whole array were printed at the end.
+class StatRequestHandler {
+   public:
+    StatRequestHandler(const Network& network, std::ostream& output);
 
-        void operator()(const io::UnknownRequest&);
+    StatRequestHandler(const StatRequestHandler&) = delete;
+    StatRequestHandler& operator=(const StatRequestHandler&) = delete;
 
-        void Print();
+    void HandleStatRequests(const io::JsonReader& json_reader);
 
-       private:
-        json::Array responses_;
-        const TransportCatalogue& transport_catalogue_;
-        render::MapRenderer& map_renderer_;
-        const TransportRouter& router_;
-        std::ostream& output_;
+    void Handle(const io::StatRequest& stat_request);
 
-        void HandleNotFound(int id);
+    // Closes the output; nothing is written when no request came at all.
+    void Finish();
 
-        struct ItemVisitor {
-            ItemVisitor(json::Array& items);
+   private:
+    json::Array responses_;
+    StatHandler stat_handler_;
+    json::ArrayPrinter printer_;
+};
 
-            void operator()(const TransportRouter::WaitItem&);
+// Answers each stat request from the shard its region names or, without a
+// region, from the shard whose stop prefix the requested stop (or bus) name
+// has; requests naming neither go to the shard without a prefix. Suggest
+// without a region asks every shard, since a prefix may span several, and
+// merges their answers. Responses are written as StatRequestHandler writes
+// them.
+class ShardedStatRequestHandler {
+   public:
+    ShardedStatRequestHandler(const ShardedNetwork& network,
+                              std::ostream& output);
 
-            void operator()(const TransportRouter::BusItem&);
+    ShardedStatRequestHandler(const ShardedStatRequestHandler&) = delete;
+    ShardedStatRequestHandler& operator=(const ShardedStatRequestHandler&) =
+        delete;
 
-           private:
-            json::Array& items_;
-        };
-    };
+    void HandleStatRequests(const io::JsonReader& json_reader);
+
+    void Handle(const io::StatRequest& stat_request,
+                const std::string& region);
+
+    void Finish();
+
+   private:
+    const ShardedNetwork& network_;
+    json::Array responses_;
+    std::vector<StatHandler> stat_handlers_;
+    json::ArrayPrinter printer_;
+
+    void HandleSuggest(const io::GetSuggestRequest& get_suggest_request);
+
+    std::optional<size_t> FindShard(const io::StatRequest& stat_request,
+                                    const std::string& region) const;
 };
 
 }  // namespace trc::rh
@@ -1,19 +1,67 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstdint>
+#include <functional>
 #include <iterator>
 #include <optional>
+#include <ostream>
 #include <stdexcept>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "graph.h"
+#include "memory_usage.h"
 
 namespace graph {
 
+// Snapshot of the all-pairs precompute state passed to progress callbacks.
+struct BuildProgress {
+    size_t vertices_processed = 0;
+    size_t vertex_count = 0;
+    std::chrono::steady_clock::duration elapsed{};
+    std::chrono::steady_clock::duration estimated_remaining{};
+    // The routes table is allocated up front, so its size is the peak.
+    size_t peak_memory_bytes = 0;
+};
+
+// Lets the owner of a long Router build observe it and abort it. The build
+// throws BuildCancelled once the deadline passes or *cancelled becomes true.
+struct BuildControl {
+    using Clock = std::chrono::steady_clock;
+
+    std::function<void(const BuildProgress&)> on_progress;
+    Clock::duration report_interval = std::chrono::seconds(1);
+    std::optional<Clock::time_point> deadline;
+    const std::atomic<bool>* cancelled = nullptr;
+};
+
+class BuildCancelled : public std::runtime_error {
+   public:
+    using runtime_error::runtime_error;
+};
+
+// Progress callback writing one line per report, e.g. to std::cerr.
+inline std::function<void(const BuildProgress&)> MakeProgressPrinter(
+    std::ostream& out) {
+    return [&out](const BuildProgress& progress) {
+        using std::chrono::duration_cast;
+        using std::chrono::seconds;
+
+        out << "router: " << progress.vertices_processed << '/'
+            << progress.vertex_count << " vertices, elapsed "
+            << duration_cast<seconds>(progress.elapsed).count()
+            << "s, remaining ~"
+            << duration_cast<seconds>(progress.estimated_remaining).count()
+            << "s, memory " << progress.peak_memory_bytes / (1024 * 1024)
+            << " MiB" << std::endl;
+    };
+}
+
 template <typename Weight>
 class Router {
    private:
@@ -25,7 +73,10 @@ class Router {
     };
 
    public:
-    explicit Router(const Graph& graph);
+    explicit Router(const Graph& graph, const BuildControl& control = {});
+
+    // Size of the routes table built for a graph with vertex_count vertices.
+    static size_t EstimateMemoryBytes(size_t vertex_count);
 
     struct RouteInfo {
         Weight weight;
@@ -34,6 +85,8 @@ class Router {
 
     std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
 
+    memory::MemoryUsage GetMemoryUsage() const;
+
     // TODO: delete
     const std::vector<typename Graph::IncidenceList> GetIncidenceList() const {
         return graph_.GetIncidenceList();
@@ -105,26 +158,92 @@ class Router {
         }
     }
 
+    static void CheckCancelled(const BuildControl& control) {
+        if (control.cancelled &&
+            control.cancelled->load(std::memory_order_relaxed)) {
+            throw BuildCancelled("Router build has been cancelled");
+        }
+
+        if (control.deadline && BuildControl::Clock::now() > *control.deadline) {
+            throw BuildCancelled("Router build has exceeded its deadline");
+        }
+    }
+
     static constexpr Weight ZERO_WEIGHT{};
     const Graph& graph_;
     RoutesInternalData routes_internal_data_;
 };
 
 template <typename Weight>
-Router<Weight>::Router(const Graph& graph)
-    : graph_(graph),
-      routes_internal_data_(graph.GetVertexCount(),
-                            std::vector<std::optional<RouteInternalData>>(
-                                graph.GetVertexCount())) {
-    InitializeRoutesInternalData(graph);
+size_t Router<Weight>::EstimateMemoryBytes(size_t vertex_count) {
+    return vertex_count *
+           (sizeof(std::vector<std::optional<RouteInternalData>>) +
+            vertex_count * sizeof(std::optional<RouteInternalData>));
+}
+
+template <typename Weight>
+Router<Weight>::Router(const Graph& graph, const BuildControl& control)
+    : graph_(graph) {
+    using Clock = BuildControl::Clock;
 
     const size_t vertex_count = graph.GetVertexCount();
+
+    BuildProgress progress;
+    progress.vertex_count = vertex_count;
+    progress.peak_memory_bytes = EstimateMemoryBytes(vertex_count);
+
+    CheckCancelled(control);
+
+    routes_internal_data_.assign(
+        vertex_count,
+        std::vector<std::optional<RouteInternalData>>(vertex_count));
+
+    InitializeRoutesInternalData(graph);
+
+    const Clock::time_point start = Clock::now();
+    Clock::time_point last_report = start;
+
     for (VertexId vertex_through = 0; vertex_through < vertex_count;
          ++vertex_through) {
+        CheckCancelled(control);
+
         RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+
+        if (!control.on_progress) {
+            continue;
+        }
+
+        const Clock::time_point now = Clock::now();
+        const bool is_last = vertex_through + 1 == vertex_count;
+
+        if (is_last || now - last_report >= control.report_interval) {
+            progress.vertices_processed = vertex_through + 1;
+            progress.elapsed = now - start;
+            // Every pass over an intermediate vertex costs the same, so the
+            // remaining time extrapolates linearly.
+            progress.estimated_remaining =
+                progress.elapsed *
+                static_cast<Clock::rep>(vertex_count -
+                                        progress.vertices_processed) /
+                static_cast<Clock::rep>(progress.vertices_processed);
+            control.on_progress(progress);
+            last_report = now;
+        }
     }
 }
 
+template <typename Weight>
+memory::MemoryUsage Router<Weight>::GetMemoryUsage() const {
+    size_t routes = memory::GetCapacityBytes(routes_internal_data_);
+    for (const auto& row : routes_internal_data_) {
+        routes += memory::GetCapacityBytes(row);
+    }
+
+    memory::MemoryUsage usage;
+    usage.Add("routes", routes);
+    return usage;
+}
+
 template <typename Weight>
 std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(
     VertexId from, VertexId to) const {
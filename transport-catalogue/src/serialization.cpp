@@ -1,6 +1,8 @@
 #include "serialization.h"
 
 #include <fstream>
+#include <optional>
+#include <stdexcept>
 #include <unordered_map>
 
 namespace trc {
@@ -23,7 +25,34 @@ Serializer::Data Serializer::Load() const {
 
     ser_data.ParseFromIstream(&input);
 
-    return Convert(ser_data);
+    // Each delta yields a new catalogue built from the previous one, which
+    // is then destroyed and replaced in place.
+    std::optional<TransportCatalogue> trc(
+        Convert(ser_data.transport_catalogue()));
+
+    for (const auto& delta_file : settings_.deltas) {
+        trc.emplace(ApplyDelta(*trc, LoadDelta(delta_file)));
+    }
+
+    return {std::move(*trc), Convert(ser_data.render_settings()),
+            Convert(ser_data.router_settings())};
+}
+
+void Serializer::SaveDelta(const NetworkDelta& delta) const {
+    std::ofstream output(settings_.file, std::ios::binary);
+    Convert(delta).SerializeToOstream(&output);
+}
+
+NetworkDelta Serializer::LoadDelta(const SerializationSettings::Path& file) {
+    trc_serialization::Delta ser_delta;
+
+    std::ifstream input(file, std::ios::binary);
+
+    if (!ser_delta.ParseFromIstream(&input)) {
+        throw std::runtime_error("Cannot read delta " + file.string());
+    }
+
+    return Convert(ser_delta);
 }
 
 trc_serialization::SerializationData Serializer::Convert(
@@ -40,13 +69,9 @@ trc_serialization::SerializationData Serializer::Convert(
 
 Serializer::Data Serializer::Convert(
     const trc_serialization::SerializationData& ser_data) {
-    Data data;
-
-    data.trc = Convert(ser_data.transport_catalogue());
-    data.render_settings = Convert(ser_data.render_settings());
-    data.router_settings = Convert(ser_data.router_settings());
-
-    return data;
+    return {Convert(ser_data.transport_catalogue()),
+            Convert(ser_data.render_settings()),
+            Convert(ser_data.router_settings())};
 }
 
 trc_serialization::TransportCatalogue Serializer::Convert(
@@ -58,18 +83,22 @@ trc_serialization::TransportCatalogue Serializer::Convert(
         *ser_trc.add_stop() = Convert(stop);
     });
 
-    const auto& stop_to_stop_to_distance = trc.GetDistances();
-    std::for_each(
-        stop_to_stop_to_distance.begin(), stop_to_stop_to_distance.end(),
-        [&ser_trc](const std::pair<const Stop*,
-                                   std::unordered_map<const Stop*, double>>&
-                       stop_distances) {
-            *ser_trc.add_distance() = Convert(stop_distances);
+    std::vector<StopDistances> stop_distances(trc.GetStopCount());
+    trc.GetDistances().ForEach(
+        [&stop_distances](StopId from, StopId to, double distance) {
+            stop_distances[from].first = from;
+            stop_distances[from].second.emplace_back(to, distance);
         });
 
+    for (const auto& from_stop_distances : stop_distances) {
+        if (!from_stop_distances.second.empty()) {
+            *ser_trc.add_distance() = Convert(from_stop_distances);
+        }
+    }
+
     const auto& buses = trc.GetBuses();
-    std::for_each(buses.begin(), buses.end(), [&ser_trc](const Bus& bus) {
-        *ser_trc.add_bus() = Convert(bus);
+    std::for_each(buses.begin(), buses.end(), [&ser_trc, &trc](const Bus& bus) {
+        *ser_trc.add_bus() = Convert(bus, trc.GetRoute(bus));
     });
 
     return ser_trc;
@@ -79,25 +108,110 @@ TransportCatalogue Serializer::Convert(
     const trc_serialization::TransportCatalogue& ser_trc) {
     TransportCatalogue trc;
 
+    size_t route_stop_count = 0;
+    for (const auto& ser_bus : ser_trc.bus()) {
+        route_stop_count += GetListedStopCount(ser_bus);
+    }
+
+    size_t distance_count = 0;
+    for (const auto& ser_distance : ser_trc.distance()) {
+        distance_count += ser_distance.distance_info_size();
+    }
+
+    trc.Reserve(ser_trc.stop_size(), ser_trc.bus_size(), route_stop_count,
+                distance_count);
+
+    StopIdMap stop_ids;
+    stop_ids.reserve(ser_trc.stop_size());
+
     for (size_t i = 0; i < ser_trc.stop_size(); ++i) {
-        trc.AddStop(Convert(ser_trc.stop(i)));
+        const auto& ser_stop = ser_trc.stop(i);
+        stop_ids[ser_stop.id()] = trc.AddStop(Convert(ser_stop));
     }
 
     for (size_t i = 0; i < ser_trc.distance_size(); ++i) {
-        auto [from_stop, to_stop_to_distance] =
-            Convert(ser_trc.distance(i), trc.GetStopIdToStop());
-        for (const auto [to_stop, distance] : to_stop_to_distance) {
-            trc.AddDistance(from_stop->name, to_stop->name, distance);
+        const auto [from_stop, to_stop_to_distance] =
+            Convert(ser_trc.distance(i), stop_ids);
+        for (const auto& [to_stop, distance] : to_stop_to_distance) {
+            trc.AddDistance(from_stop, to_stop, distance);
         }
     }
 
     for (size_t i = 0; i < ser_trc.bus_size(); ++i) {
-        trc.AddBus(Convert(ser_trc.bus(i), trc.GetStopIdToStop()));
+        const auto [bus, route] = Convert(ser_trc.bus(i), stop_ids);
+        trc.AddBus(bus, route);
     }
 
     return trc;
 }
 
+trc_serialization::Delta Serializer::Convert(const NetworkDelta& delta) {
+    trc_serialization::Delta ser_delta;
+
+    for (const auto& name : delta.removed_stops) {
+        ser_delta.add_removed_stop(name);
+    }
+
+    for (const auto& name : delta.removed_buses) {
+        ser_delta.add_removed_bus(name);
+    }
+
+    for (const auto& stop : delta.stops) {
+        auto& ser_stop = *ser_delta.add_stop();
+        ser_stop.set_name(stop.name);
+        *ser_stop.mutable_coordinates() = Convert(stop.coordinates);
+    }
+
+    for (const auto& distance : delta.distances) {
+        auto& ser_distance = *ser_delta.add_distance();
+        ser_distance.set_from(distance.from);
+        ser_distance.set_to(distance.to);
+        ser_distance.set_distance(distance.distance);
+    }
+
+    for (const auto& bus : delta.buses) {
+        auto& ser_bus = *ser_delta.add_bus();
+        ser_bus.set_name(bus.name);
+        for (const auto& stop : bus.stops) {
+            ser_bus.add_stop(stop);
+        }
+        ser_bus.set_is_roundtrip(bus.is_roundtrip);
+    }
+
+    return ser_delta;
+}
+
+NetworkDelta Serializer::Convert(const trc_serialization::Delta& ser_delta) {
+    NetworkDelta delta;
+
+    delta.removed_stops.assign(ser_delta.removed_stop().begin(),
+                               ser_delta.removed_stop().end());
+    delta.removed_buses.assign(ser_delta.removed_bus().begin(),
+                               ser_delta.removed_bus().end());
+
+    delta.stops.reserve(ser_delta.stop_size());
+    for (const auto& ser_stop : ser_delta.stop()) {
+        delta.stops.push_back(
+            {ser_stop.name(), Convert(ser_stop.coordinates())});
+    }
+
+    delta.distances.reserve(ser_delta.distance_size());
+    for (const auto& ser_distance : ser_delta.distance()) {
+        delta.distances.push_back({ser_distance.from(), ser_distance.to(),
+                                   ser_distance.distance()});
+    }
+
+    delta.buses.reserve(ser_delta.bus_size());
+    for (const auto& ser_bus : ser_delta.bus()) {
+        delta.buses.push_back(
+            {ser_bus.name(),
+             {ser_bus.stop().begin(), ser_bus.stop().end()},
+             ser_bus.is_roundtrip()});
+    }
+
+    return delta;
+}
+
 trc_serialization::RenderSettings Serializer::Convert(
     const render::RenderSettings& rs) {
     trc_serialization::RenderSettings ser_rs;
@@ -153,6 +267,21 @@ trc_serialization::RouterSettings Serializer::Convert(
 
     ser_rs.set_bus_wait_time(rs.bus_wait_time);
     ser_rs.set_bus_velocity(rs.bus_velocity);
+    ser_rs.set_max_expanded_vertices(rs.max_expanded_vertices);
+    ser_rs.set_memory_budget_mb(rs.memory_budget_mb);
+    ser_rs.set_max_build_time(rs.max_build_time);
+
+    switch (rs.engine) {
+        case TransportRouter::Engine::AUTO:
+            ser_rs.set_engine(trc_serialization::AUTO);
+            break;
+        case TransportRouter::Engine::ALL_PAIRS:
+            ser_rs.set_engine(trc_serialization::ALL_PAIRS);
+            break;
+        case TransportRouter::Engine::DIJKSTRA:
+            ser_rs.set_engine(trc_serialization::DIJKSTRA);
+            break;
+    }
 
     return ser_rs;
 }
@@ -164,6 +293,29 @@ TransportRouter::Settings Serializer::Convert(
     rs.bus_wait_time = ser_rs.bus_wait_time();
     rs.bus_velocity = ser_rs.bus_velocity();
 
+    // Bases written before the limit existed keep the default one.
+    if (ser_rs.max_expanded_vertices() != 0) {
+        rs.max_expanded_vertices = ser_rs.max_expanded_vertices();
+    }
+
+    if (ser_rs.memory_budget_mb() != 0) {
+        rs.memory_budget_mb = ser_rs.memory_budget_mb();
+    }
+
+    rs.max_build_time = ser_rs.max_build_time();
+
+    switch (ser_rs.engine()) {
+        case trc_serialization::ALL_PAIRS:
+            rs.engine = TransportRouter::Engine::ALL_PAIRS;
+            break;
+        case trc_serialization::DIJKSTRA:
+            rs.engine = TransportRouter::Engine::DIJKSTRA;
+            break;
+        default:
+            rs.engine = TransportRouter::Engine::AUTO;
+            break;
+    }
+
     return rs;
 }
 
@@ -171,7 +323,7 @@ trc_serialization::Stop Serializer::Convert(const Stop& s) {
     trc_serialization::Stop ser_s;
 
     ser_s.set_id(s.id);
-    ser_s.set_name(s.name);
+    ser_s.set_name(s.name.data(), s.name.size());
     *ser_s.mutable_coordinates() = Convert(s.coordinates);
 
     return ser_s;
@@ -180,7 +332,6 @@ trc_serialization::Stop Serializer::Convert(const Stop& s) {
 Stop Serializer::Convert(const trc_serialization::Stop& ser_s) {
     Stop s;
 
-    s.id = ser_s.id();
     s.name = ser_s.name();
     s.coordinates = Convert(ser_s.coordinates());
 
@@ -206,93 +357,106 @@ geo::Coordinates Serializer::Convert(
     return c;
 }
 
-trc_serialization::StopDistances Serializer::Convert(
-    const std::pair<const Stop*, std::unordered_map<const Stop*, double>>& sd) {
+trc_serialization::StopDistances Serializer::Convert(const StopDistances& sd) {
     trc_serialization::StopDistances ser_sd;
 
     const auto& [from_stop, to_stop_to_distance] = sd;
 
-    ser_sd.set_from_stop_id(from_stop->id);
+    ser_sd.set_from_stop_id(from_stop);
 
     std::for_each(to_stop_to_distance.begin(), to_stop_to_distance.end(),
-                  [&ser_sd](std::pair<const Stop*, double> stop_to_distance) {
+                  [&ser_sd](std::pair<StopId, double> stop_to_distance) {
                       *ser_sd.add_distance_info() = Convert(stop_to_distance);
                   });
 
     return ser_sd;
 }
 
-std::pair<const Stop*, std::unordered_map<const Stop*, double>>
-Serializer::Convert(
+Serializer::StopDistances Serializer::Convert(
     const trc_serialization::StopDistances& ser_sd,
-    const std::unordered_map<uint32_t, const Stop*>& stop_id_to_stop) {
-    std::pair<const Stop*, std::unordered_map<const Stop*, double>> sd;
+    const StopIdMap& stop_ids) {
+    StopDistances sd;
     auto& [from_stop, to_stop_to_distance] = sd;
 
-    from_stop = stop_id_to_stop.at(ser_sd.from_stop_id());
+    from_stop = stop_ids.at(ser_sd.from_stop_id());
+
+    to_stop_to_distance.reserve(ser_sd.distance_info_size());
 
     for (size_t i = 0; i < ser_sd.distance_info_size(); ++i) {
-        to_stop_to_distance.emplace(
-            Convert(ser_sd.distance_info(i), stop_id_to_stop));
+        to_stop_to_distance.push_back(
+            Convert(ser_sd.distance_info(i), stop_ids));
     }
 
     return sd;
 }
 
 trc_serialization::DistanceInfo Serializer::Convert(
-    std::pair<const Stop*, double> di) {
+    std::pair<StopId, double> di) {
     trc_serialization::DistanceInfo ser_di;
 
-    ser_di.set_to_stop_id(di.first->id);
+    ser_di.set_to_stop_id(di.first);
     ser_di.set_distance(di.second);
 
     return ser_di;
 }
 
-std::pair<const Stop*, double> Serializer::Convert(
+std::pair<StopId, double> Serializer::Convert(
     const trc_serialization::DistanceInfo& ser_di,
-    const std::unordered_map<uint32_t, const Stop*>& stop_id_to_stop) {
-    std::pair<const Stop*, double> di;
+    const StopIdMap& stop_ids) {
+    std::pair<StopId, double> di;
 
-    di.first = stop_id_to_stop.at(ser_di.to_stop_id());
+    di.first = stop_ids.at(ser_di.to_stop_id());
     di.second = ser_di.distance();
 
     return di;
 }
 
-trc_serialization::Bus Serializer::Convert(const Bus& b) {
+trc_serialization::Bus Serializer::Convert(const Bus& b, RouteView route) {
     trc_serialization::Bus ser_b;
 
-    ser_b.set_name(b.name);
+    ser_b.set_name(b.name.data(), b.name.size());
 
-    std::for_each(b.route.begin(), b.route.end(),
+    std::for_each(route.begin(), route.end(),
                   [&ser_b](const Stop* stop) { ser_b.add_stop(stop->id); });
 
     ser_b.set_route_length(b.route_length);
     ser_b.set_curvature(b.curvature);
     ser_b.set_is_roundtrip(b.is_roundtrip);
+    ser_b.set_unique_stop_count(b.unique_stop_count);
 
     return ser_b;
 }
 
-Bus Serializer::Convert(
-    const trc_serialization::Bus& ser_b,
-    const std::unordered_map<uint32_t, const Stop*>& stop_id_to_stop) {
-    Bus b;
+Serializer::BusRoute Serializer::Convert(const trc_serialization::Bus& ser_b,
+                                        const StopIdMap& stop_ids) {
+    BusRoute bus_route;
+    auto& [b, route] = bus_route;
 
     b.name = ser_b.name();
 
-    b.route.reserve(ser_b.stop_size());
+    const size_t listed_stop_count = GetListedStopCount(ser_b);
+    route.reserve(listed_stop_count);
 
-    for (size_t i = 0; i < ser_b.stop_size(); ++i) {
-        b.route.push_back(stop_id_to_stop.at(ser_b.stop(i)));
+    for (size_t i = 0; i < listed_stop_count; ++i) {
+        route.push_back(stop_ids.at(ser_b.stop(i)));
     }
 
     b.route_length = ser_b.route_length();
     b.curvature = ser_b.curvature();
     b.is_roundtrip = ser_b.is_roundtrip();
+    b.unique_stop_count = ser_b.unique_stop_count();
+
+    return bus_route;
+}
+
+size_t Serializer::GetListedStopCount(const trc_serialization::Bus& ser_b) {
+    const size_t stop_count = ser_b.stop_size();
+
+    if (ser_b.is_roundtrip() || stop_count == 0) {
+        return stop_count;
+    }
 
-    return b;
+    return stop_count / 2 + 1;
 }
 
 trc_serialization::Point Serializer::Convert(svg::Point p) {
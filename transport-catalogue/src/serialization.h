@@ -3,7 +3,10 @@
 #include <transport_catalogue.pb.h>
 
 #include <filesystem>
+#include <unordered_map>
+#include <vector>
 
+#include "delta.h"
 #include "map_renderer.h"
 #include "transport_catalogue.h"
 #include "transport_router.h"
@@ -14,6 +17,8 @@ struct SerializationSettings {
     using Path = std::filesystem::path;
 
     Path file;
+    // Delta files applied on top of the base by Load, in order.
+    std::vector<Path> deltas;
 };
 
 class Serializer {
@@ -32,6 +37,9 @@ class Serializer {
 
     Data Load() const;
 
+    // Writes a delta, instead of a base, to the configured file.
+    void SaveDelta(const NetworkDelta& delta) const;
+
    private:
     SerializationSettings settings_;
 
@@ -46,6 +54,11 @@ class Serializer {
     static TransportCatalogue Convert(
         const trc_serialization::TransportCatalogue& ser_trc);
 
+    static NetworkDelta LoadDelta(const SerializationSettings::Path& file);
+
+    static trc_serialization::Delta Convert(const NetworkDelta& delta);
+    static NetworkDelta Convert(const trc_serialization::Delta& ser_delta);
+
     static trc_serialization::RenderSettings Convert(
         const render::RenderSettings& rs);
     static render::RenderSettings Convert(
@@ -63,23 +76,36 @@ class Serializer {
     static geo::Coordinates Convert(
         const trc_serialization::Coordinates& ser_c);
 
+    // Ids written to the base mapped to the ids given out by the loading
+    // catalogue, which need not coincide.
+    using StopIdMap = std::unordered_map<uint32_t, StopId>;
+
+    // Distances from one stop, grouped the way they are stored in the base.
+    using StopDistances =
+        std::pair<StopId, std::vector<std::pair<StopId, double>>>;
+
     static trc_serialization::StopDistances Convert(
-        const std::pair<const Stop*, std::unordered_map<const Stop*, double>>&
-            stop_distances);
-    static std::pair<const Stop*, std::unordered_map<const Stop*, double>>
-    Convert(const trc_serialization::StopDistances& ser_sd,
-            const std::unordered_map<uint32_t, const Stop*>& stop_id_to_stop);
+        const StopDistances& stop_distances);
+    static StopDistances Convert(
+        const trc_serialization::StopDistances& ser_sd,
+        const StopIdMap& stop_ids);
 
     static trc_serialization::DistanceInfo Convert(
-        std::pair<const Stop*, double> di);
-    static std::pair<const Stop*, double> Convert(
+        std::pair<StopId, double> di);
+    static std::pair<StopId, double> Convert(
         const trc_serialization::DistanceInfo& ser_di,
-        const std::unordered_map<uint32_t, const Stop*>& stop_id_to_stop);
+        const StopIdMap& stop_ids);
+
+    // A bus together with the stop ids of its route.
+    using BusRoute = std::pair<Bus, std::vector<StopId>>;
+
+    static trc_serialization::Bus Convert(const Bus& b, RouteView route);
+    static BusRoute Convert(const trc_serialization::Bus& ser_b,
+                            const StopIdMap& stop_ids);
 
-    static trc_serialization::Bus Convert(const Bus& b);
-    static Bus Convert(
-        const trc_serialization::Bus& ser_b,
-        const std::unordered_map<uint32_t, const Stop*>& stop_id_to_stop);
+    // The base keeps the full there-and-back sequence of a linear bus, so
+    // that its format does not change; only the first half is loaded.
+    static size_t GetListedStopCount(const trc_serialization::Bus& ser_b);
 
     static trc_serialization::Point Convert(svg::Point p);
     static svg::Point Convert(const trc_serialization::Point& ser_p);
@@ -0,0 +1,75 @@
+#include "sharded_network.h"
+
+#include <future>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace trc {
+
+using namespace std;
+
+ShardedNetwork::ShardedNetwork(const vector<ShardSettings>& settings,
+                               const graph::BuildControl& build_control) {
+    unordered_set<string_view> regions;
+    for (const auto& shard : settings) {
+        if (shard.region.empty() || !regions.insert(shard.region).second) {
+            throw invalid_argument("Empty or repeated region: " +
+                                   shard.region);
+        }
+    }
+
+    vector<future<unique_ptr<const Network>>> loads;
+    loads.reserve(settings.size());
+
+    for (const auto& shard : settings) {
+        loads.push_back(async(launch::async, [&shard, &build_control] {
+            auto [catalogue, render_settings, router_settings] =
+                Serializer(shard.serialization).Load();
+
+            return make_unique<const Network>(1, move(catalogue),
+                                              move(render_settings),
+                                              router_settings,
+                                              build_control);
+        }));
+    }
+
+    shards_.reserve(settings.size());
+
+    for (size_t i = 0; i < settings.size(); ++i) {
+        shards_.push_back({settings[i].region, settings[i].stop_prefix,
+                           loads[i].get()});
+    }
+}
+
+size_t ShardedNetwork::GetShardCount() const { return shards_.size(); }
+
+const ShardedNetwork::Shard& ShardedNetwork::GetShard(size_t index) const {
+    return shards_.at(index);
+}
+
+optional<size_t> ShardedNetwork::FindRegion(string_view region) const {
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        if (shards_[i].region == region) {
+            return i;
+        }
+    }
+
+    return nullopt;
+}
+
+optional<size_t> ShardedNetwork::FindShardByName(string_view name) const {
+    optional<size_t> result;
+
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        const string& prefix = shards_[i].stop_prefix;
+
+        if (name.substr(0, prefix.size()) == prefix &&
+            (!result || shards_[*result].stop_prefix.size() < prefix.size())) {
+            result = i;
+        }
+    }
+
+    return result;
+}
+
+}  // namespace trc
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "network.h"
+#include "serialization.h"
+
+namespace trc {
+
+struct ShardSettings {
+    std::string region;
+    // Stop names of the region start with it. Empty for the shard that
+    // takes requests no other prefix matches.
+    std::string stop_prefix;
+    SerializationSettings serialization;
+};
+
+// Several independent networks, one per region, served by one process.
+// Each shard keeps its own catalogue, router and render settings.
+class ShardedNetwork {
+   public:
+    struct Shard {
+        std::string region;
+        std::string stop_prefix;
+        std::unique_ptr<const Network> network;
+    };
+
+    // Loads every shard from its own base file on a separate thread, so
+    // each shard's memory is allocated by the thread that builds it.
+    // Throws std::invalid_argument on an empty or repeated region and
+    // rethrows the first error any shard failed to load with. Every
+    // shard's router build shares build_control.
+    explicit ShardedNetwork(const std::vector<ShardSettings>& settings,
+                            const graph::BuildControl& build_control = {});
+
+    size_t GetShardCount() const;
+
+    const Shard& GetShard(size_t index) const;
+
+    std::optional<size_t> FindRegion(std::string_view region) const;
+
+    // Shard with the longest stop prefix name starts with.
+    std::optional<size_t> FindShardByName(std::string_view name) const;
+
+   private:
+    std::vector<Shard> shards_;
+};
+
+}  // namespace trc
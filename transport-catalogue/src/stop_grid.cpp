@@ -0,0 +1,194 @@
+#include "stop_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace trc {
+
+namespace {
+
+constexpr double DEGREE = 3.1415926535 / 180.;
+constexpr double EARTH_RADIUS = 6371'000.0;
+
+// Distances and bounds round differently; bounds are lowered by this much
+// to stay on the safe side.
+constexpr double ROUNDING_SLACK = 1.0;
+
+bool IsCloser(const StopGrid::NearbyStop& lhs,
+              const StopGrid::NearbyStop& rhs) {
+    return lhs.distance < rhs.distance ||
+           (lhs.distance == rhs.distance && lhs.id < rhs.id);
+}
+
+}  // namespace
+
+StopGrid::StopGrid(std::pmr::memory_resource* resource, double cell_size)
+    : cell_size_(cell_size), cells_(resource) {}
+
+void StopGrid::Insert(StopId id, geo::Coordinates coordinates) {
+    cells_[Pack(ToCell(coordinates))].push_back(
+        {id, geo::ToTrigCoordinates(coordinates)});
+    ++size_;
+}
+
+void StopGrid::Erase(StopId id, geo::Coordinates coordinates) {
+    const auto cell_it = cells_.find(Pack(ToCell(coordinates)));
+
+    if (cell_it == cells_.end()) {
+        return;
+    }
+
+    auto& entries = cell_it->second;
+    const auto it = std::find_if(entries.begin(), entries.end(),
+                                 [id](const Entry& entry) {
+                                     return entry.id == id;
+                                 });
+
+    if (it == entries.end()) {
+        return;
+    }
+
+    entries.erase(it);
+    --size_;
+
+    if (entries.empty()) {
+        cells_.erase(cell_it);
+    }
+}
+
+std::vector<StopGrid::NearbyStop> StopGrid::FindNearest(
+    geo::Coordinates center, size_t count) const {
+    if (count == 0) {
+        return {};
+    }
+
+    auto candidates = Collect(
+        center, [count](std::vector<NearbyStop>& candidates, double bound) {
+            if (candidates.size() < count) {
+                return false;
+            }
+
+            std::nth_element(candidates.begin(),
+                             candidates.begin() + (count - 1),
+                             candidates.end(), IsCloser);
+
+            return candidates[count - 1].distance <= bound;
+        });
+
+    const size_t result_size = std::min(count, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + result_size,
+                      candidates.end(), IsCloser);
+    candidates.resize(result_size);
+
+    return candidates;
+}
+
+std::vector<StopGrid::NearbyStop> StopGrid::FindWithin(geo::Coordinates center,
+                                                       double radius) const {
+    auto candidates =
+        Collect(center, [radius](std::vector<NearbyStop>&, double bound) {
+            return bound > radius;
+        });
+
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                    [radius](const NearbyStop& candidate) {
+                                        return candidate.distance > radius;
+                                    }),
+                     candidates.end());
+    std::sort(candidates.begin(), candidates.end(), IsCloser);
+
+    return candidates;
+}
+
+size_t StopGrid::GetSize() const { return size_; }
+
+memory::MemoryUsage StopGrid::GetMemoryUsage() const {
+    size_t entries = 0;
+    for (const auto& [key, cell] : cells_) {
+        entries += memory::GetCapacityBytes(cell);
+    }
+
+    memory::MemoryUsage usage;
+    usage.Add("cells", memory::GetCapacityBytes(cells_));
+    usage.Add("entries", entries);
+    return usage;
+}
+
+StopGrid::Cell StopGrid::ToCell(geo::Coordinates coordinates) const {
+    return {static_cast<int32_t>(std::floor(coordinates.lat / cell_size_)),
+            static_cast<int32_t>(std::floor(coordinates.lng / cell_size_))};
+}
+
+uint64_t StopGrid::Pack(Cell cell) {
+    return static_cast<uint64_t>(static_cast<uint32_t>(cell.row)) << 32 |
+           static_cast<uint32_t>(cell.col);
+}
+
+double StopGrid::GetLowerBound(geo::Coordinates center, int32_t ring) const {
+    if (ring < 2) {
+        return 0.0;
+    }
+
+    // A stop outside the first `ring` rings is at least ring - 1 whole
+    // cells away in latitude, or in longitude while staying within `ring`
+    // rows of center. In the latter case the haversine formula gives
+    // sin(d / 2R) >= cos(max |lat|) * sin(dlng / 2).
+    const double span = (ring - 1) * cell_size_ * DEGREE;
+    const double max_lat =
+        std::min(90.0, std::abs(center.lat) + ring * cell_size_) * DEGREE;
+
+    const double half_lng_span = std::min(span, 180 * DEGREE) / 2;
+
+    const double lat_bound = EARTH_RADIUS * span;
+    const double lng_bound =
+        2 * EARTH_RADIUS *
+        std::asin(std::cos(max_lat) * std::sin(half_lng_span));
+
+    return std::max(0.0, std::min(lat_bound, lng_bound) - ROUNDING_SLACK);
+}
+
+void StopGrid::CollectRing(const geo::TrigCoordinates& center, Cell origin,
+                           int32_t ring,
+                           std::vector<NearbyStop>& candidates) const {
+    const auto collect_cell = [this, &center, &candidates](Cell cell) {
+        const auto it = cells_.find(Pack(cell));
+
+        if (it == cells_.end()) {
+            return;
+        }
+
+        for (const Entry& entry : it->second) {
+            candidates.push_back(
+                {entry.id, geo::ComputeDistance(center, entry.coordinates)});
+        }
+    };
+
+    if (ring == 0) {
+        collect_cell(origin);
+        return;
+    }
+
+    for (int32_t offset = -ring; offset <= ring; ++offset) {
+        collect_cell({origin.row - ring, origin.col + offset});
+        collect_cell({origin.row + ring, origin.col + offset});
+    }
+
+    for (int32_t offset = -ring + 1; offset < ring; ++offset) {
+        collect_cell({origin.row + offset, origin.col - ring});
+        collect_cell({origin.row + offset, origin.col + ring});
+    }
+}
+
+void StopGrid::CollectAll(const geo::TrigCoordinates& center,
+                          std::vector<NearbyStop>& candidates) const {
+    candidates.reserve(size_);
+
+    for (const auto& [key, entries] : cells_) {
+        for (const Entry& entry : entries) {
+            candidates.push_back(
+                {entry.id, geo::ComputeDistance(center, entry.coordinates)});
+        }
+    }
+}
+
+}  // namespace trc
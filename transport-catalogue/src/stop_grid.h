@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+
+#include "domain.h"
+#include "geo.h"
+#include "memory_usage.h"
+
+namespace trc {
+
+// Stops bucketed by a uniform latitude/longitude grid. Only cells holding
+// stops are stored, so the size does not depend on the area covered. A
+// query scans rings of cells around the point and stops as soon as no
+// farther cell can hold a closer stop. The grid does not wrap around the
+// antimeridian.
+class StopGrid {
+   public:
+    struct NearbyStop {
+        StopId id;
+        double distance;
+    };
+
+    // About 1.1 km along a meridian.
+    static constexpr double DEFAULT_CELL_SIZE = 0.01;
+
+    explicit StopGrid(
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+        double cell_size = DEFAULT_CELL_SIZE);
+
+    void Insert(StopId id, geo::Coordinates coordinates);
+
+    void Erase(StopId id, geo::Coordinates coordinates);
+
+    // At most count stops closest to center, nearest first.
+    std::vector<NearbyStop> FindNearest(geo::Coordinates center,
+                                        size_t count) const;
+
+    // Stops no farther than radius meters from center, nearest first.
+    std::vector<NearbyStop> FindWithin(geo::Coordinates center,
+                                       double radius) const;
+
+    size_t GetSize() const;
+
+    memory::MemoryUsage GetMemoryUsage() const;
+
+   private:
+    struct Entry {
+        StopId id;
+        geo::TrigCoordinates coordinates;
+    };
+
+    struct Cell {
+        int32_t row;
+        int32_t col;
+    };
+
+    double cell_size_;
+    std::pmr::unordered_map<uint64_t, std::pmr::vector<Entry>> cells_;
+    size_t size_ = 0;
+
+    Cell ToCell(geo::Coordinates coordinates) const;
+
+    static uint64_t Pack(Cell cell);
+
+    // Distance in meters that no stop outside the first `ring` rings around
+    // center's cell can beat.
+    double GetLowerBound(geo::Coordinates center, int32_t ring) const;
+
+    // Adds the stops of the cells at Chebyshev distance `ring` from origin.
+    void CollectRing(const geo::TrigCoordinates& center, Cell origin,
+                     int32_t ring, std::vector<NearbyStop>& candidates) const;
+
+    void CollectAll(const geo::TrigCoordinates& center,
+                    std::vector<NearbyStop>& candidates) const;
+
+    // Widens the search ring by ring until is_complete(candidates, bound)
+    // holds, bound being the lower bound for any stop not yet collected.
+    template <typename IsComplete>
+    std::vector<NearbyStop> Collect(geo::Coordinates center,
+                                    IsComplete is_complete) const;
+};
+
+template <typename IsComplete>
+std::vector<StopGrid::NearbyStop> StopGrid::Collect(
+    geo::Coordinates center, IsComplete is_complete) const {
+    std::vector<NearbyStop> candidates;
+    const Cell origin = ToCell(center);
+    const geo::TrigCoordinates trig_center = geo::ToTrigCoordinates(center);
+
+    for (int32_t ring = 0; candidates.size() < size_; ++ring) {
+        // Once a ring has more cells than the grid holds, walking the
+        // occupied cells is cheaper than probing empty ones.
+        if (8 * static_cast<size_t>(ring) > cells_.size()) {
+            candidates.clear();
+            CollectAll(trig_center, candidates);
+            break;
+        }
+
+        CollectRing(trig_center, origin, ring, candidates);
+
+        if (is_complete(candidates, GetLowerBound(center, ring + 1))) {
+            break;
+        }
+    }
+
+    return candidates;
+}
+
+}  // namespace trc
@@ -0,0 +1,55 @@
+#include "symbol_table.h"
+
+#include <cstring>
+
+namespace trc {
+
+SymbolTable::SymbolTable(std::pmr::memory_resource* resource)
+    : resource_(resource), names_(resource), name_to_id_(resource) {}
+
+void SymbolTable::Reserve(size_t count) {
+    names_.reserve(count);
+    name_to_id_.reserve(count);
+}
+
+SymbolTable::Id SymbolTable::Intern(std::string_view name) {
+    if (const auto it = name_to_id_.find(name); it != name_to_id_.end()) {
+        return it->second;
+    }
+
+    char* data = static_cast<char*>(resource_->allocate(name.size(), 1));
+    std::memcpy(data, name.data(), name.size());
+
+    const Id id = static_cast<Id>(names_.size());
+    names_.emplace_back(data, name.size());
+    name_to_id_.emplace(names_.back(), id);
+
+    return id;
+}
+
+std::optional<SymbolTable::Id> SymbolTable::Find(std::string_view name) const {
+    if (const auto it = name_to_id_.find(name); it != name_to_id_.end()) {
+        return it->second;
+    }
+
+    return std::nullopt;
+}
+
+std::string_view SymbolTable::GetName(Id id) const { return names_.at(id); }
+
+size_t SymbolTable::GetSize() const { return names_.size(); }
+
+memory::MemoryUsage SymbolTable::GetMemoryUsage() const {
+    size_t characters = 0;
+    for (const std::string_view name : names_) {
+        characters += name.size();
+    }
+
+    memory::MemoryUsage usage;
+    usage.Add("names", memory::GetCapacityBytes(names_));
+    usage.Add("index", memory::GetCapacityBytes(name_to_id_));
+    usage.Add("characters", characters);
+    return usage;
+}
+
+}  // namespace trc
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "memory_usage.h"
+
+namespace trc {
+
+// Interns names into dense ids assigned in order of first appearance. The
+// characters of every name are copied once into the memory resource and
+// never handed back, so it is meant to be an arena; views returned by
+// GetName stay valid for as long as the resource lives.
+class SymbolTable {
+   public:
+    using Id = uint32_t;
+
+    explicit SymbolTable(std::pmr::memory_resource* resource);
+
+    void Reserve(size_t count);
+
+    Id Intern(std::string_view name);
+
+    std::optional<Id> Find(std::string_view name) const;
+
+    std::string_view GetName(Id id) const;
+
+    size_t GetSize() const;
+
+    memory::MemoryUsage GetMemoryUsage() const;
+
+   private:
+    std::pmr::memory_resource* resource_;
+    std::pmr::vector<std::string_view> names_;
+    std::pmr::unordered_map<std::string_view, Id> name_to_id_;
+};
+
+}  // namespace trc
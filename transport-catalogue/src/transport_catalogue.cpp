@@ -1,7 +1,9 @@
 #include "transport_catalogue.h"
 
+#include <algorithm>
 #include <cmath>
 #include <numeric>
+#include <stdexcept>
 #include <unordered_set>
 
 #include "geo.h"
@@ -10,155 +12,328 @@ namespace trc {
 
 using namespace std;
 
-void TransportCatalogue::AddStop(Stop&& stop) {
-    stops_.push_front(std::move(stop));
-    stop_id_to_stop_[stop.id] = &stops_.front();
-    stop_name_to_stop_[stops_.front().name] = &stops_.front();
-    stop_name_to_buses_[stops_.front().name];
+TransportCatalogue::TransportCatalogue()
+    : arena_(std::make_unique<Arena>()),
+      stops_(arena_->GetResource()),
+      stop_trig_coordinates_(arena_->GetResource()),
+      buses_(arena_->GetResource()),
+      route_stop_ids_(arena_->GetResource()),
+      stop_symbols_(arena_->GetResource()),
+      bus_symbols_(arena_->GetResource()),
+      bus_id_to_info_(arena_->GetResource()),
+      stop_id_to_bus_names_(arena_->GetResource()),
+      stop_grid_(arena_->GetResource()) {}
+
+void TransportCatalogue::Reserve(size_t stop_count, size_t bus_count,
+                                 size_t route_stop_count,
+                                 size_t distance_count) {
+    stop_symbols_.Reserve(stop_count);
+    bus_symbols_.Reserve(bus_count);
+    stops_.reserve(stop_count);
+    stop_trig_coordinates_.reserve(stop_count);
+    stop_id_to_bus_names_.reserve(stop_count);
+    buses_.reserve(bus_count);
+    bus_id_to_info_.reserve(bus_count);
+    route_stop_ids_.reserve(route_stop_count);
+    distances_.Reserve(distance_count);
 }
 
-void TransportCatalogue::AddBus(const string& bus_name,
+void TransportCatalogue::ShrinkToFit() { distances_.ShrinkToFit(); }
+
+TransportCatalogue::AllocationStats TransportCatalogue::GetAllocationStats()
+    const {
+    return arena_->GetStats();
+}
+
+memory::MemoryUsage TransportCatalogue::GetMemoryUsage() const {
+    size_t bus_names = memory::GetCapacityBytes(stop_id_to_bus_names_);
+    for (const auto& names : stop_id_to_bus_names_) {
+        bus_names += memory::GetCapacityBytes(names);
+    }
+
+    memory::MemoryUsage usage;
+    usage.Add("stops", memory::GetCapacityBytes(stops_));
+    usage.Add("stop_trig_coordinates",
+              memory::GetCapacityBytes(stop_trig_coordinates_));
+    usage.Add("buses", memory::GetCapacityBytes(buses_));
+    usage.Add("route_stop_ids", memory::GetCapacityBytes(route_stop_ids_));
+    usage.Add("stop_symbols", stop_symbols_.GetMemoryUsage());
+    usage.Add("bus_symbols", bus_symbols_.GetMemoryUsage());
+    usage.Add("bus_info", memory::GetCapacityBytes(bus_id_to_info_));
+    usage.Add("stop_bus_names", bus_names);
+    usage.Add("distances", distances_.GetMemoryUsage());
+    usage.Add("stop_grid", stop_grid_.GetMemoryUsage());
+    return usage;
+}
+
+StopId TransportCatalogue::AddStop(Stop&& stop) {
+    const StopId stop_id = stop_symbols_.Intern(stop.name);
+    stop.id = stop_id;
+    stop.name = stop_symbols_.GetName(stop_id);
+
+    const geo::TrigCoordinates trig_coordinates =
+        geo::ToTrigCoordinates(stop.coordinates);
+
+    if (stop_id == stops_.size()) {
+        stop_grid_.Insert(stop_id, stop.coordinates);
+        stops_.push_back(std::move(stop));
+        stop_trig_coordinates_.push_back(trig_coordinates);
+        stop_id_to_bus_names_.emplace_back();
+    } else {
+        stop_grid_.Erase(stop_id, stops_[stop_id].coordinates);
+        stop_grid_.Insert(stop_id, stop.coordinates);
+        stops_[stop_id] = std::move(stop);
+        stop_trig_coordinates_[stop_id] = trig_coordinates;
+    }
+
+    return stop_id;
+}
+
+void TransportCatalogue::AddBus(string_view bus_name,
                                 const vector<string>& route,
                                 bool is_roundtrip = false) {
+    vector<StopId> stop_ids;
+    stop_ids.reserve(route.size());
+
+    for (const auto& stop : route) {
+        stop_ids.push_back(GetStopByName(stop)->id);
+    }
+
+    InsertBus(MakeBus(bus_name, stop_ids, is_roundtrip), stop_ids);
+}
+
+Bus TransportCatalogue::MakeBus(string_view bus_name,
+                                const vector<StopId>& route,
+                                bool is_roundtrip) const {
     Bus bus{bus_name};
     bus.is_roundtrip = is_roundtrip;
-    bus.route.reserve(route.size());
 
-    for (const auto& stop : route) {
-        bus.route.push_back(stop_name_to_stop_.at(stop));
+    const RouteView route_view(stops_.data(), route.data(), route.size(),
+                               !is_roundtrip);
+
+    bus.route_length = ComputeRouteLength(route_view);
+    bus.curvature = bus.route_length /
+                    ComputeRouteGeographicLength(route, !is_roundtrip);
+    bus.unique_stop_count = ComputeUniqueStopCount(route);
+
+    return bus;
+}
+
+void TransportCatalogue::AddBus(const Bus& bus, const vector<StopId>& route) {
+    Bus restored_bus(bus);
+
+    // Bases written before the count was stored do not carry it.
+    if (restored_bus.unique_stop_count == 0) {
+        restored_bus.unique_stop_count = ComputeUniqueStopCount(route);
     }
 
-    if (!bus.is_roundtrip) {
-        for (int i = bus.route.size() - 2; i >= 0; i--) {
-            bus.route.push_back(bus.route[i]);
-        }
+    InsertBus(std::move(restored_bus), route);
+}
+
+BusId TransportCatalogue::InsertBus(Bus&& bus, const vector<StopId>& route) {
+    const BusId bus_id = bus_symbols_.Intern(bus.name);
+    bus.name = bus_symbols_.GetName(bus_id);
+
+    if (bus_id < buses_.size()) {
+        EraseRoute(bus_id);
+    }
+
+    bus.route_begin = static_cast<uint32_t>(route_stop_ids_.size());
+    bus.route_size = static_cast<uint32_t>(route.size());
+    route_stop_ids_.insert(route_stop_ids_.end(), route.begin(), route.end());
+
+    const BusInfo bus_info{GetRoute(bus).size(), bus.unique_stop_count,
+                           bus.route_length, bus.curvature};
+
+    if (bus_id == buses_.size()) {
+        buses_.push_back(std::move(bus));
+        bus_id_to_info_.push_back(bus_info);
+    } else {
+        buses_[bus_id] = std::move(bus);
+        bus_id_to_info_[bus_id] = bus_info;
     }
 
-    bus.route_length = ComputeRouteLength(bus);
-    bus.curvature = bus.route_length / ComputeRouteGeographicLength(bus);
-    buses_.push_front(std::move(bus));
-    bus_name_to_bus_[buses_.front().name] = &buses_.front();
+    const std::string_view bus_name = bus_symbols_.GetName(bus_id);
+
+    for (const StopId stop_id : route) {
+        auto& bus_names = stop_id_to_bus_names_[stop_id];
+        const auto it =
+            std::lower_bound(bus_names.begin(), bus_names.end(), bus_name);
 
-    for (const Stop* stop : buses_.front().route) {
-        stop_name_to_buses_[stop->name].push_back(&buses_.front());
+        if (it == bus_names.end() || *it != bus_name) {
+            bus_names.insert(it, bus_name);
+        }
     }
+
+    return bus_id;
 }
 
-void TransportCatalogue::AddBus(const Bus& bus) {
-    buses_.push_front(bus);
-    bus_name_to_bus_[buses_.front().name] = &buses_.front();
+void TransportCatalogue::EraseRoute(BusId bus_id) {
+    const uint32_t route_begin = buses_[bus_id].route_begin;
+    const uint32_t route_size = buses_[bus_id].route_size;
+    const std::string_view bus_name = bus_symbols_.GetName(bus_id);
 
-    for (const Stop* stop : buses_.front().route) {
-        stop_name_to_buses_[stop->name].push_back(&buses_.front());
+    const auto route_it = route_stop_ids_.begin() + route_begin;
+
+    for (auto it = route_it; it != route_it + route_size; ++it) {
+        auto& bus_names = stop_id_to_bus_names_[*it];
+        const auto name_it =
+            std::lower_bound(bus_names.begin(), bus_names.end(), bus_name);
+
+        if (name_it != bus_names.end() && *name_it == bus_name) {
+            bus_names.erase(name_it);
+        }
+    }
+
+    route_stop_ids_.erase(route_it, route_it + route_size);
+
+    for (Bus& bus : buses_) {
+        if (bus.route_begin > route_begin) {
+            bus.route_begin -= route_size;
+        }
     }
 }
 
-void TransportCatalogue::AddDistance(const string& stop_from,
-                                     const string& stop_to, double distance) {
-    const Stop* from = stop_name_to_stop_.at(stop_from);
-    const Stop* to = stop_name_to_stop_.at(stop_to);
+void TransportCatalogue::AddDistance(string_view stop_from,
+                                     string_view stop_to, double distance) {
+    AddDistance(GetStopByName(stop_from)->id, GetStopByName(stop_to)->id,
+                distance);
+}
 
-    stop_to_stop_to_distance_[from][to] = distance;
+void TransportCatalogue::AddDistance(StopId from, StopId to, double distance) {
+    distances_.Set(from, to, distance);
 }
 
-optional<set<string>> TransportCatalogue::GetStopInfo(
-    const string& stop_name) const {
-    if (!stop_name_to_buses_.count(stop_name)) {
-        return {};
-    }
+optional<TransportCatalogue::BusNames> TransportCatalogue::GetStopInfo(
+    string_view stop_name) const {
+    const optional<StopId> stop_id = FindStopId(stop_name);
 
-    set<string> buses;
-    for (const Bus* bus : stop_name_to_buses_.at(stop_name)) {
-        buses.insert(bus->name);
+    if (!stop_id.has_value()) {
+        return {};
     }
 
-    return {std::move(buses)};
+    return ranges::AsRange(stop_id_to_bus_names_[*stop_id]);
 }
 
 optional<TransportCatalogue::BusInfo> TransportCatalogue::GetBusInfo(
-    const string& bus_name) const {
-    if (!bus_name_to_bus_.count(bus_name)) {
+    string_view bus_name) const {
+    const optional<BusId> bus_id = FindBusId(bus_name);
+
+    if (!bus_id.has_value()) {
         return {};
     }
 
-    const Bus& bus = *bus_name_to_bus_.at(bus_name);
+    return bus_id_to_info_[*bus_id];
+}
+
+const Stop* TransportCatalogue::GetStopByName(string_view stop_name) const {
+    const optional<StopId> stop_id = FindStopId(stop_name);
+
+    if (!stop_id.has_value()) {
+        throw out_of_range("Unknown stop: " + string(stop_name));
+    }
+
+    return &stops_[*stop_id];
+}
 
-    size_t unique_stops_count =
-        unordered_set(bus.route.begin(), bus.route.end()).size();
+optional<StopId> TransportCatalogue::FindStopId(string_view stop_name) const {
+    return stop_symbols_.Find(stop_name);
+}
 
-    return {{bus.route.size(), unique_stops_count, bus.route_length,
-             bus.curvature}};
+optional<BusId> TransportCatalogue::FindBusId(string_view bus_name) const {
+    return bus_symbols_.Find(bus_name);
 }
 
-const Stop* TransportCatalogue::GetStopByName(const string& stop_name) const {
-    return stop_name_to_stop_.at(stop_name);
+const pmr::vector<Bus>& TransportCatalogue::GetBuses() const {
+    return buses_;
 }
 
-const std::deque<Bus>& TransportCatalogue::GetBuses() const { return buses_; }
+const pmr::vector<Stop>& TransportCatalogue::GetStops() const {
+    return stops_;
+}
 
-const std::deque<Stop>& TransportCatalogue::GetStops() const { return stops_; }
+RouteView TransportCatalogue::GetRoute(const Bus& bus) const {
+    return {stops_.data(), route_stop_ids_.data() + bus.route_begin,
+            bus.route_size, !bus.is_roundtrip};
+}
+
+RouteView TransportCatalogue::GetListedStops(const Bus& bus) const {
+    return {stops_.data(), route_stop_ids_.data() + bus.route_begin,
+            bus.route_size};
+}
+
+vector<StopGrid::NearbyStop> TransportCatalogue::FindNearestStops(
+    geo::Coordinates center, size_t count) const {
+    return stop_grid_.FindNearest(center, count);
+}
+
+vector<StopGrid::NearbyStop> TransportCatalogue::FindStopsWithin(
+    geo::Coordinates center, double radius) const {
+    return stop_grid_.FindWithin(center, radius);
+}
 
 size_t TransportCatalogue::GetStopCount() const { return stops_.size(); }
 
-double TransportCatalogue::ComputeRouteLength(const Bus& bus) const {
-    if (bus.route.size() == 0) {
+double TransportCatalogue::ComputeRouteLength(RouteView route) const {
+    if (route.size() == 0) {
         return 0.0;
     }
 
-    if (bus.route.size() == 1) {
-        if (stop_to_stop_to_distance_.count(bus.route[0]) &&
-            stop_to_stop_to_distance_.at(bus.route[0]).count(bus.route[0])) {
-            return stop_to_stop_to_distance_.at(bus.route[0]).at(bus.route[0]);
-        }
-
-        return 0.0;
+    if (route.size() == 1) {
+        return distances_.Find(route[0]->id, route[0]->id).value_or(0.0);
     }
 
     double route_length = 0.0;
 
-    for (size_t i = 1; i < bus.route.size(); ++i) {
-        route_length += GetDistance(bus.route[i - 1], bus.route[i]);
+    for (size_t i = 1; i < route.size(); ++i) {
+        route_length += GetDistance(route[i - 1], route[i]);
     }
 
     return route_length;
 }
 
-double TransportCatalogue::ComputeRouteGeographicLength(const Bus& bus) const {
-    if (bus.route.size() < 2) {
+uint32_t TransportCatalogue::ComputeUniqueStopCount(
+    const vector<StopId>& route) {
+    return static_cast<uint32_t>(
+        unordered_set(route.begin(), route.end()).size());
+}
+
+double TransportCatalogue::ComputeRouteGeographicLength(
+    const vector<StopId>& route, bool is_mirrored) const {
+    if (route.size() < 2) {
         return 0.0;
     }
 
-    double route_geo_length = 0.0;
-    for (size_t i = 1; i < bus.route.size(); ++i) {
-        route_geo_length += ComputeDistance(bus.route[i - 1]->coordinates,
-                                            bus.route[i]->coordinates);
+    vector<geo::TrigCoordinates> points;
+    points.reserve(route.size());
+    for (const StopId stop_id : route) {
+        points.push_back(stop_trig_coordinates_[stop_id]);
     }
 
-    return route_geo_length;
-}
+    vector<double> distances(route.size() - 1);
+    geo::ComputeDistances(points.data(), points.data() + 1, distances.size(),
+                          distances.data());
+
+    const double length = accumulate(distances.begin(), distances.end(), 0.0);
 
-const std::unordered_map<const Stop*, std::unordered_map<const Stop*, double>>&
-TransportCatalogue::GetDistances() const {
-    return stop_to_stop_to_distance_;
+    return is_mirrored ? 2 * length : length;
 }
 
-const std::unordered_map<uint32_t, const Stop*>&
-TransportCatalogue::GetStopIdToStop() const {
-    return stop_id_to_stop_;
+const DistanceTable& TransportCatalogue::GetDistances() const {
+    return distances_;
 }
 
 double TransportCatalogue::GetDistance(const Stop* from, const Stop* to) const {
-    if (stop_to_stop_to_distance_.count(from) &&
-        stop_to_stop_to_distance_.at(from).count(to)) {
-        return stop_to_stop_to_distance_.at(from).at(to);
+    if (const auto distance = distances_.Find(from->id, to->id)) {
+        return *distance;
     }
 
-    if (stop_to_stop_to_distance_.count(to) &&
-        stop_to_stop_to_distance_.at(to).count(from)) {
-        return stop_to_stop_to_distance_.at(to).at(from);
+    if (const auto distance = distances_.Find(to->id, from->id)) {
+        return *distance;
     }
 
-    return ComputeDistance(from->coordinates, to->coordinates);
+    return geo::ComputeDistance(stop_trig_coordinates_[from->id],
+                                stop_trig_coordinates_[to->id]);
 }
 
 }  // namespace trc
@@ -1,14 +1,20 @@
 #pragma once
 
-#include <deque>
+#include <memory>
+#include <memory_resource>
 #include <optional>
-#include <set>
 #include <string>
 #include <string_view>
 #include <unordered_map>
 #include <vector>
 
+#include "arena.h"
+#include "distance_table.h"
 #include "domain.h"
+#include "memory_usage.h"
+#include "ranges.h"
+#include "stop_grid.h"
+#include "symbol_table.h"
 
 namespace trc {
 
@@ -21,53 +27,143 @@ class TransportCatalogue {
         double curvature;
     };
 
-    TransportCatalogue() = default;
+    // Names of the buses serving a stop, sorted and without repeats.
+    using BusNames =
+        ranges::Range<std::pmr::vector<std::string_view>::const_iterator>;
 
-    void AddStop(Stop&& stop);
+    using AllocationStats = Arena::Stats;
 
-    void AddBus(const std::string& bus_name,
+    TransportCatalogue();
+
+    // Names and containers point into the arena, which a copy would not
+    // share; moves keep it, as it is held by pointer.
+    TransportCatalogue(const TransportCatalogue&) = delete;
+    TransportCatalogue& operator=(const TransportCatalogue&) = delete;
+    // Moving keeps the arena together with the containers allocating from
+    // it. Assignment is deleted: pmr containers do not take over the
+    // allocator of the source, so a catalogue is built in place instead.
+    TransportCatalogue(TransportCatalogue&&) = default;
+    TransportCatalogue& operator=(TransportCatalogue&&) = delete;
+
+    // Sizes the storage once for a bulk load, so that it is not
+    // reallocated while stops and buses are added.
+    void Reserve(size_t stop_count, size_t bus_count, size_t route_stop_count,
+                 size_t distance_count = 0);
+
+    // Releases the spare capacity left after the last stop or bus is added.
+    // Memory of the arena is only returned when the catalogue is destroyed,
+    // so this affects the heap-backed distance table alone.
+    void ShrinkToFit();
+
+    // How many allocations the arena absorbed and how many blocks it took
+    // from the heap for them.
+    AllocationStats GetAllocationStats() const;
+
+    // Bytes held by each container. Most of them live in the arena, so
+    // they add up to at most its block bytes; the distance table does not.
+    memory::MemoryUsage GetMemoryUsage() const;
+
+    // Gives the stop the next dense id of this catalogue, or the id it
+    // already has if a stop with that name was added before. No state is
+    // shared between catalogues, so they can be built on different threads.
+    StopId AddStop(Stop&& stop);
+
+    void AddBus(std::string_view bus_name,
                 const std::vector<std::string>& route, bool is_roundtrip);
 
-    void AddBus(const Bus& bus);
+    // A bus with the statistics of its route of listed stops, not added yet.
+    // It only reads the catalogue, so once the stops and distances are in,
+    // buses can be prepared on several threads and added afterwards.
+    Bus MakeBus(std::string_view bus_name, const std::vector<StopId>& route,
+                bool is_roundtrip) const;
 
-    void AddDistance(const std::string& stop_from, const std::string& stop_to,
+    // Restores a bus whose statistics are already known, e.g. from a base.
+    // route holds the listed stops, without the return leg of a linear bus.
+    void AddBus(const Bus& bus, const std::vector<StopId>& route);
+
+    void AddDistance(std::string_view stop_from, std::string_view stop_to,
                      double distance);
 
-    std::optional<std::set<std::string>> GetStopInfo(
-        const std::string& stop_name) const;
+    void AddDistance(StopId from, StopId to, double distance);
 
-    std::optional<BusInfo> GetBusInfo(const std::string& bus_name) const;
+    // Query methods take string_view so that names can be looked up
+    // straight from a request buffer without building std::string.
+    std::optional<BusNames> GetStopInfo(std::string_view stop_name) const;
 
-    const Stop* GetStopByName(const std::string& stop_name) const;
+    std::optional<BusInfo> GetBusInfo(std::string_view bus_name) const;
 
-    const std::deque<Bus>& GetBuses() const;
+    const Stop* GetStopByName(std::string_view stop_name) const;
 
-    const std::deque<Stop>& GetStops() const;
+    std::optional<StopId> FindStopId(std::string_view stop_name) const;
 
-    size_t GetStopCount() const;
+    std::optional<BusId> FindBusId(std::string_view bus_name) const;
 
-    const std::unordered_map<const Stop*,
-                             std::unordered_map<const Stop*, double>>&
-    GetDistances() const;
+    // Buses indexed by BusId.
+    const std::pmr::vector<Bus>& GetBuses() const;
 
-    double GetDistance(const Stop* from, const Stop* to) const;
+    // Stops indexed by StopId.
+    const std::pmr::vector<Stop>& GetStops() const;
 
-    const std::unordered_map<uint32_t, const Stop*>& GetStopIdToStop() const;
+    // Full route as the bus travels it, including the way back of a linear
+    // bus.
+    RouteView GetRoute(const Bus& bus) const;
 
-   private:
-    std::deque<Stop> stops_;
-    std::deque<Bus> buses_;
+    // Stops as listed for the bus: a linear route ends at its terminal.
+    RouteView GetListedStops(const Bus& bus) const;
+
+    // Nearest stops by great-circle distance, answered from a grid index
+    // kept up to date by AddStop.
+    std::vector<StopGrid::NearbyStop> FindNearestStops(geo::Coordinates center,
+                                                       size_t count) const;
+
+    std::vector<StopGrid::NearbyStop> FindStopsWithin(geo::Coordinates center,
+                                                      double radius) const;
 
-    std::unordered_map<uint32_t, const Stop*> stop_id_to_stop_;
-    std::unordered_map<std::string_view, const Stop*> stop_name_to_stop_;
-    std::unordered_map<std::string_view, const Bus*> bus_name_to_bus_;
-    std::unordered_map<const Stop*, std::unordered_map<const Stop*, double>>
-        stop_to_stop_to_distance_;
-    std::unordered_map<std::string_view, std::vector<const Bus*>>
-        stop_name_to_buses_;
+    size_t GetStopCount() const;
+
+    const DistanceTable& GetDistances() const;
 
-    double ComputeRouteLength(const Bus& bus) const;
+    double GetDistance(const Stop* from, const Stop* to) const;
 
-    double ComputeRouteGeographicLength(const Bus& bus) const;
+   private:
+    // Declared first: everything below allocates from it. Names, routes and
+    // index nodes are freed in one go when the catalogue is destroyed.
+    std::unique_ptr<Arena> arena_;
+
+    std::pmr::vector<Stop> stops_;
+    // Indexed like stops_, so the trigonometry of a stop is done once.
+    std::pmr::vector<geo::TrigCoordinates> stop_trig_coordinates_;
+    std::pmr::vector<Bus> buses_;
+    // Stop ids of all routes back to back; Bus::route_begin indexes it.
+    std::pmr::vector<StopId> route_stop_ids_;
+
+    // Names are hashed only here, at the request boundary; everything
+    // else is keyed by the interned ids.
+    SymbolTable stop_symbols_;
+    SymbolTable bus_symbols_;
+
+    // Answers for Bus requests, computed once when a bus is added.
+    std::pmr::vector<BusInfo> bus_id_to_info_;
+    // Views into bus_symbols_, kept sorted as buses are added.
+    std::pmr::vector<std::pmr::vector<std::string_view>> stop_id_to_bus_names_;
+    // A single table rehashed as it grows, so it stays on the heap where
+    // old tables can be freed.
+    DistanceTable distances_;
+    StopGrid stop_grid_;
+
+    // A bus added under a name already taken replaces the earlier one.
+    BusId InsertBus(Bus&& bus, const std::vector<StopId>& route);
+
+    // Drops the bus's route and its name from the stops along it.
+    void EraseRoute(BusId bus_id);
+
+    double ComputeRouteLength(RouteView route) const;
+
+    // Over the listed stops; the way back of a mirrored route adds the same
+    // great-circle length again.
+    double ComputeRouteGeographicLength(const std::vector<StopId>& route,
+                                        bool is_mirrored) const;
+
+    static uint32_t ComputeUniqueStopCount(const std::vector<StopId>& route);
 };
 }  // namespace trc
@@ -1,39 +1,238 @@
 #include "transport_router.h"
 
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#include "k_shortest_paths.h"
+
 namespace trc {
 
 TransportRouter::TransportRouter(
     const TransportRouter::Settings& router_settings,
-    const TransportCatalogue& transport_catalogue)
+    const TransportCatalogue& transport_catalogue,
+    const graph::BuildControl& build_control)
     : transport_catalogue_(transport_catalogue),
       router_settings_(router_settings),
-      stop_id_to_stop_(InitIdToStop(transport_catalogue)),
-      stop_name_to_index_(InitStopNameToId(stop_id_to_stop_)),
-      transport_graph_(BuildGraph()),
-      router_(transport_graph_) {}
+      stops_(transport_catalogue.GetStops()),
+      transport_graph_(BuildGraph()) {
+    const EngineEstimate estimate =
+        SelectEngine(router_settings_, transport_graph_.GetVertexCount(),
+                     transport_graph_.GetEdgeCount());
+
+    LogEngine(estimate, std::clog);
+
+    engine_ = estimate.engine;
+
+    if (engine_ == Engine::ALL_PAIRS) {
+        graph::BuildControl control = build_control;
+
+        if (!control.deadline && router_settings_.max_build_time > 0) {
+            using Clock = graph::BuildControl::Clock;
+
+            const std::chrono::duration<double> max_build_time(
+                router_settings_.max_build_time);
+            control.deadline =
+                Clock::now() +
+                std::chrono::duration_cast<Clock::duration>(max_build_time);
+        }
+
+        router_.emplace(transport_graph_, control);
+    }
+}
 
 std::optional<TransportRouter::RouteInfo> TransportRouter::BuildRoute(
-    const std::string& from_stop, const std::string& to_stop) const {
-    graph::VertexId route_start =
-        stop_name_to_index_.at(from_stop) + stop_id_to_stop_.size();
+    std::string_view from_stop, std::string_view to_stop) const {
+    const auto route_start = FindWaitVertex(from_stop);
+    const auto route_end = FindWaitVertex(to_stop);
+
+    if (!route_start.has_value() || !route_end.has_value()) {
+        return std::nullopt;
+    }
+
+    auto route_info_raw = FindShortestRoute(*route_start, *route_end);
+
+    if (!route_info_raw.has_value()) {
+        return std::nullopt;
+    }
+
+    return MakeRouteInfo(route_info_raw->weight.time, route_info_raw->edges);
+}
+
+TransportRouter::Alternatives TransportRouter::BuildAlternatives(
+    std::string_view from_stop, std::string_view to_stop,
+    size_t count) const {
+    const auto route_start = FindWaitVertex(from_stop);
+    const auto route_end = FindWaitVertex(to_stop);
+
+    if (!route_start.has_value() || !route_end.has_value()) {
+        return {};
+    }
+
+    auto route_info_raw = FindShortestRoute(*route_start, *route_end);
+
+    if (!route_info_raw.has_value()) {
+        return {};
+    }
+
+    graph::KShortestPaths<Weight> k_shortest_paths(
+        transport_graph_, router_settings_.max_expanded_vertices);
+
+    const auto paths = k_shortest_paths.Find(*route_start, *route_end, count,
+                                             std::move(route_info_raw));
+
+    ++alternatives_request_count_;
+    alternatives_expanded_vertex_count_ += paths.expanded_vertex_count;
+    if (paths.limit_reached) {
+        ++alternatives_limit_reached_count_;
+    }
+
+    Alternatives alternatives;
+    alternatives.limit_reached = paths.limit_reached;
+    alternatives.routes.reserve(paths.routes.size());
+
+    for (const auto& path : paths.routes) {
+        alternatives.routes.push_back(
+            MakeRouteInfo(path.weight.time, path.edges));
+    }
+
+    return alternatives;
+}
 
-    graph::VertexId route_end =
-        stop_name_to_index_.at(to_stop) + stop_id_to_stop_.size();
+TransportRouter::AlternativesStats TransportRouter::GetAlternativesStats()
+    const {
+    return {alternatives_request_count_.load(),
+            alternatives_limit_reached_count_.load(),
+            alternatives_expanded_vertex_count_.load()};
+}
+
+memory::MemoryUsage TransportRouter::GetMemoryUsage() const {
+    memory::MemoryUsage usage;
+    usage.Add("graph", transport_graph_.GetMemoryUsage());
+    if (router_) {
+        usage.Add("all_pairs", router_->GetMemoryUsage());
+    }
+    return usage;
+}
+
+std::optional<std::vector<TransportRouter::ReachableStop>>
+TransportRouter::FindReachableStops(std::string_view from_stop,
+                                    double max_time) const {
+    const auto from_vertex = FindWaitVertex(from_stop);
+
+    if (!from_vertex.has_value()) {
+        return std::nullopt;
+    }
+
+    const size_t stop_count = stops_.size();
+
+    std::vector<ReachableStop> reachable_stops;
 
-    auto route_info_raw = router_.BuildRoute(route_start, route_end);
+    // Wait vertices are where a rider stands at a stop, so they carry the
+    // same times as Route's total_time.
+    graph::Dijkstra<Weight>(transport_graph_)
+        .VisitReachable(*from_vertex, max_time,
+                        [this, &reachable_stops, stop_count](
+                            graph::VertexId vertex, const Weight& weight) {
+                            if (vertex >= stop_count) {
+                                reachable_stops.push_back(
+                                    {stops_[vertex - stop_count].name,
+                                     weight.time});
+                            }
+                        });
+
+    return reachable_stops;
+}
+
+TransportRouter::Engine TransportRouter::GetEngine() const { return engine_; }
+
+TransportRouter::EngineEstimate TransportRouter::SelectEngine(
+    const Settings& settings, size_t vertex_count, size_t edge_count) {
+    EngineEstimate estimate;
+
+    estimate.vertex_count = vertex_count;
+    estimate.edge_count = edge_count;
+
+    // Floyd-Warshall relaxes every pair of vertices through every vertex.
+    estimate.all_pairs_memory_bytes =
+        graph::Router<Weight>::EstimateMemoryBytes(vertex_count);
+    estimate.all_pairs_operations = std::pow(vertex_count, 3);
+
+    // Binary heap Dijkstra keeps a weight, a previous edge and two flags per
+    // vertex and a ban flag per edge.
+    estimate.dijkstra_query_memory_bytes =
+        vertex_count * (sizeof(std::optional<Weight>) +
+                        sizeof(std::optional<graph::EdgeId>) + 1) +
+        edge_count / 8;
+    estimate.dijkstra_query_operations =
+        (vertex_count + edge_count) * std::log2(vertex_count + 2);
+
+    if (settings.engine != Engine::AUTO) {
+        estimate.engine = settings.engine;
+    } else if (estimate.all_pairs_memory_bytes <=
+               settings.memory_budget_mb * 1024 * 1024) {
+        estimate.engine = Engine::ALL_PAIRS;
+    } else {
+        estimate.engine = Engine::DIJKSTRA;
+    }
+
+    return estimate;
+}
+
+std::string_view TransportRouter::GetEngineName(Engine engine) {
+    switch (engine) {
+        case Engine::AUTO:
+            return "auto";
+        case Engine::ALL_PAIRS:
+            return "all_pairs";
+        case Engine::DIJKSTRA:
+            return "dijkstra";
+    }
+
+    return "unknown";
+}
+
+void TransportRouter::LogEngine(const EngineEstimate& estimate,
+                                std::ostream& log) {
+    log << "routing engine: " << GetEngineName(estimate.engine) << " ("
+        << estimate.vertex_count << " vertices, " << estimate.edge_count
+        << " edges; all_pairs: "
+        << estimate.all_pairs_memory_bytes / (1024 * 1024) << " MiB, "
+        << std::llround(estimate.all_pairs_operations)
+        << " relaxations; dijkstra: "
+        << estimate.dijkstra_query_memory_bytes / 1024 << " KiB, "
+        << std::llround(estimate.dijkstra_query_operations)
+        << " operations per query)"
+        << std::endl;
+}
+
+std::optional<graph::Dijkstra<TransportRouter::Weight>::RouteInfo>
+TransportRouter::FindShortestRoute(graph::VertexId from,
+                                   graph::VertexId to) const {
+    if (!router_) {
+        return graph::Dijkstra<Weight>(transport_graph_).BuildRoute(from, to);
+    }
+
+    auto route_info_raw = router_->BuildRoute(from, to);
 
     if (!route_info_raw.has_value()) {
         return std::nullopt;
     }
 
+    return graph::Dijkstra<Weight>::RouteInfo{route_info_raw->weight,
+                                              std::move(route_info_raw->edges)};
+}
+
+TransportRouter::RouteInfo TransportRouter::MakeRouteInfo(
+    double total_time, const std::vector<graph::EdgeId>& edges) const {
     RouteInfo route_info;
 
-    route_info.items.reserve(route_info_raw->edges.size());
-    route_info.total_time = route_info_raw->weight.time;
+    route_info.items.reserve(edges.size());
+    route_info.total_time = total_time;
 
     size_t stop_count = transport_catalogue_.GetStopCount();
 
-    for (graph::EdgeId edge_id : route_info_raw->edges) {
+    for (graph::EdgeId edge_id : edges) {
         const auto& edge = transport_graph_.GetEdge(edge_id);
 
         if (edge.weight.span_count == 0) {
@@ -41,7 +240,7 @@ std::optional<TransportRouter::RouteInfo> TransportRouter::BuildRoute(
                 edge.to >= stop_count ? edge.to - stop_count : edge.to;
 
             route_info.items.push_back(
-                WaitItem{stop_id_to_stop_.at(edge_id)->name, edge.weight.time});
+                WaitItem{stops_.at(edge_id).name, edge.weight.time});
         } else {
             route_info.items.push_back(BusItem{edge.weight.bus_name,
                                                edge.weight.span_count,
@@ -49,16 +248,16 @@ std::optional<TransportRouter::RouteInfo> TransportRouter::BuildRoute(
         }
     }
 
-    return {std::move(route_info)};
+    return route_info;
 }
 
 graph::DirectedWeightedGraph<TransportRouter::Weight>
 TransportRouter::BuildGraph() {
-    graph::DirectedWeightedGraph<Weight> graph(2 * stop_id_to_stop_.size());
+    graph::DirectedWeightedGraph<Weight> graph(2 * stops_.size());
 
-    for (size_t stop_id = 0; stop_id < stop_id_to_stop_.size(); ++stop_id) {
+    for (size_t stop_id = 0; stop_id < stops_.size(); ++stop_id) {
         graph::Edge<Weight> start_wait_to_bus_enter{
-            stop_id + stop_id_to_stop_.size(),  // from
+            stop_id + stops_.size(),  // from
             stop_id,                            // to
             {router_settings_.bus_wait_time, 0, ""}};
 
@@ -85,19 +284,19 @@ void TransportRouter::AddRouteToGraph(
 
 void TransportRouter::AddRoundTrip(
     const Bus& bus, graph::DirectedWeightedGraph<Weight>& graph) {
-    for (size_t i = 0; i < bus.route.size(); ++i) {
+    const RouteView route = transport_catalogue_.GetRoute(bus);
+
+    for (size_t i = 0; i < route.size(); ++i) {
         double accumulated_distance = 0.0;
 
-        for (size_t j = i + 1; j < bus.route.size(); ++j) {
+        for (size_t j = i + 1; j < route.size(); ++j) {
             accumulated_distance += transport_catalogue_.GetDistance(
-                bus.route.at(j - 1), bus.route.at(j));
+                route.at(j - 1), route.at(j));
 
             size_t span_count = j - i;
 
             graph::Edge<Weight> edge_to_stop_exit{
-                stop_name_to_index_.at(bus.route[i]->name),
-                stop_name_to_index_.at(bus.route[j]->name) +
-                    stop_id_to_stop_.size(),
+                route[i]->id, route[j]->id + stops_.size(),
                 {CalculateDriveTimeMinutes(accumulated_distance), span_count,
                  bus.name}};
 
@@ -108,32 +307,30 @@ void TransportRouter::AddRoundTrip(
 
 void TransportRouter::AddLinearTrip(
     const Bus& bus, graph::DirectedWeightedGraph<Weight>& graph) {
-    size_t mid_stop = bus.route.size() / 2 + 1;
+    // Edges of the way back are added alongside, so the listed stops
+    // suffice.
+    const RouteView route = transport_catalogue_.GetListedStops(bus);
 
-    for (size_t i = 0; i < mid_stop; ++i) {
+    for (size_t i = 0; i < route.size(); ++i) {
         double accumulated_distance = 0.0;
         double accumulated_distance_reverse = 0.0;
 
-        for (size_t j = i + 1; j < mid_stop; ++j) {
+        for (size_t j = i + 1; j < route.size(); ++j) {
             accumulated_distance += transport_catalogue_.GetDistance(
-                bus.route.at(j - 1), bus.route.at(j));
+                route.at(j - 1), route.at(j));
 
             accumulated_distance_reverse += transport_catalogue_.GetDistance(
-                bus.route.at(j), bus.route.at(j - 1));
+                route.at(j), route.at(j - 1));
 
             size_t span_count = j - i;
 
             graph::Edge<Weight> edge_to_stop_exit{
-                stop_name_to_index_.at(bus.route[i]->name),
-                stop_name_to_index_.at(bus.route[j]->name) +
-                    stop_id_to_stop_.size(),
+                route[i]->id, route[j]->id + stops_.size(),
                 {CalculateDriveTimeMinutes(accumulated_distance), span_count,
                  bus.name}};
 
             graph::Edge<Weight> edge_to_stop_exit_reverse{
-                stop_name_to_index_.at(bus.route[j]->name),
-                stop_name_to_index_.at(bus.route[i]->name) +
-                    stop_id_to_stop_.size(),
+                route[j]->id, route[i]->id + stops_.size(),
                 {CalculateDriveTimeMinutes(accumulated_distance_reverse),
                  span_count, bus.name}};
 
@@ -143,31 +340,16 @@ void TransportRouter::AddLinearTrip(
     }
 }
 
-std::unordered_map<std::string_view, size_t> TransportRouter::InitStopNameToId(
-    const std::vector<const Stop*>& stop_id_to_stop) {
-    std::unordered_map<std::string_view, size_t> stop_name_to_index;
-
-    for (size_t i = 0; i < stop_id_to_stop.size(); ++i) {
-        stop_name_to_index[stop_id_to_stop[i]->name] = i;
-    }
-
-    return stop_name_to_index;
-}
+std::optional<graph::VertexId> TransportRouter::FindWaitVertex(
+    std::string_view stop_name) const {
+    const std::optional<StopId> stop_id =
+        transport_catalogue_.FindStopId(stop_name);
 
-std::vector<const Stop*> TransportRouter::InitIdToStop(
-    const TransportCatalogue& transport_catalogue) {
-    const auto& stops = transport_catalogue.GetStops();
-
-    std::vector<const Stop*> stop_id_to_stop(stops.size());
-
-    int index = 0;
-
-    for (const auto& stop : stops) {
-        stop_id_to_stop[index] = &stop;
-        ++index;
+    if (!stop_id.has_value()) {
+        return std::nullopt;
     }
 
-    return stop_id_to_stop;
+    return *stop_id + stops_.size();
 }
 
 double TransportRouter::CalculateDriveTimeMinutes(double distance) {
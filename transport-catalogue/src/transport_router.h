@@ -1,20 +1,55 @@
 #pragma once
 
+#include <atomic>
+#include <optional>
+#include <ostream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <variant>
 
+#include "dijkstra.h"
 #include "graph.h"
+#include "memory_usage.h"
 #include "router.h"
 #include "transport_catalogue.h"
 
 namespace trc {
 
+// Query methods are const and keep only atomic counters, so a built router can
+// serve several threads at once over a FrozenCatalogue.
 class TransportRouter {
    public:
+    enum class Engine {
+        AUTO,
+        // Precomputed all-pairs table: fastest queries, O(V^2) memory.
+        ALL_PAIRS,
+        // Search per query: no precompute, O(V) memory per query.
+        DIJKSTRA,
+    };
+
     struct Settings {
         double bus_wait_time{0.0};
         double bus_velocity{0.0};
+        // Upper bound on vertices settled while searching alternatives for
+        // one request.
+        size_t max_expanded_vertices{100'000};
+        Engine engine{Engine::AUTO};
+        // Memory the AUTO engine may spend on routing precompute.
+        size_t memory_budget_mb{1024};
+        // Seconds the all-pairs precompute may take before it is abandoned
+        // with graph::BuildCancelled; 0 means no limit.
+        double max_build_time{0.0};
+    };
+
+    struct EngineEstimate {
+        Engine engine;
+        size_t vertex_count;
+        size_t edge_count;
+        size_t all_pairs_memory_bytes;
+        double all_pairs_operations;
+        size_t dijkstra_query_memory_bytes;
+        double dijkstra_query_operations;
     };
 
     struct EdgeInfo {
@@ -55,30 +90,81 @@ class TransportRouter {
         double total_time;
     };
 
+    struct ReachableStop {
+        std::string_view stop_name;
+        double time;
+    };
+
+    struct Alternatives {
+        std::vector<RouteInfo> routes;
+        bool limit_reached = false;
+    };
+
+    struct AlternativesStats {
+        size_t request_count = 0;
+        size_t limit_reached_count = 0;
+        size_t expanded_vertex_count = 0;
+    };
+
+    // A deadline in build_control takes precedence over max_build_time.
     TransportRouter(const Settings& router_settings,
-                    const TransportCatalogue& transport_catalogue);
+                    const TransportCatalogue& transport_catalogue,
+                    const graph::BuildControl& build_control = {});
 
-    std::optional<RouteInfo> BuildRoute(const std::string& from_stop,
-                                        const std::string& to_stop) const;
+    std::optional<RouteInfo> BuildRoute(std::string_view from_stop,
+                                        std::string_view to_stop) const;
+
+    // Up to count loop-free itineraries, the first one being BuildRoute's.
+    Alternatives BuildAlternatives(std::string_view from_stop,
+                                   std::string_view to_stop,
+                                   size_t count) const;
+
+    AlternativesStats GetAlternativesStats() const;
+
+    // The graph, and the all-pairs table when that engine is used.
+    memory::MemoryUsage GetMemoryUsage() const;
+
+    // Stops reachable from from_stop within max_time minutes, including
+    // from_stop itself, ordered by travel time. One search is run and it
+    // stops at the time bound.
+    std::optional<std::vector<ReachableStop>> FindReachableStops(
+        std::string_view from_stop, double max_time) const;
+
+    Engine GetEngine() const;
+
+    // Resolves AUTO into a concrete engine from the graph size: the
+    // all-pairs table is chosen whenever it fits into memory_budget_mb.
+    static EngineEstimate SelectEngine(const Settings& settings,
+                                       size_t vertex_count, size_t edge_count);
+
+    static std::string_view GetEngineName(Engine engine);
 
    private:
     const trc::TransportCatalogue& transport_catalogue_;
     Settings router_settings_;
 
-    std::vector<const Stop*> stop_id_to_stop_;
-    std::unordered_map<std::string_view, size_t> stop_name_to_index_;
+    const std::pmr::vector<Stop>& stops_;
     graph::DirectedWeightedGraph<Weight> transport_graph_;
-    graph::Router<Weight> router_;
+    Engine engine_;
+    std::optional<graph::Router<Weight>> router_;
 
-    graph::DirectedWeightedGraph<Weight> BuildGraph();
+    mutable std::atomic<size_t> alternatives_request_count_{0};
+    mutable std::atomic<size_t> alternatives_limit_reached_count_{0};
+    mutable std::atomic<size_t> alternatives_expanded_vertex_count_{0};
+
+    std::optional<graph::Dijkstra<Weight>::RouteInfo> FindShortestRoute(
+        graph::VertexId from, graph::VertexId to) const;
 
-    void InitRouter();
+    static void LogEngine(const EngineEstimate& estimate, std::ostream& log);
 
-    static std::vector<const Stop*> InitIdToStop(
-        const TransportCatalogue& transport_catalogue);
+    RouteInfo MakeRouteInfo(double total_time,
+                            const std::vector<graph::EdgeId>& edges) const;
+
+    graph::DirectedWeightedGraph<Weight> BuildGraph();
 
-    static std::unordered_map<std::string_view, size_t> InitStopNameToId(
-        const std::vector<const Stop*>& stop_id_to_stop);
+    // Vertex a rider waits at: stop ids shifted by the stop count.
+    std::optional<graph::VertexId> FindWaitVertex(
+        std::string_view stop_name) const;
 
     void AddRouteToGraph(const Bus& bus,
                          graph::DirectedWeightedGraph<Weight>& graph);
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace trc {
+
+// Read-copy-update holder for immutable state. Readers pin the current
+// version with Acquire and keep using it for as long as they hold the
+// pointer; a writer builds a replacement on the side and Publishes it.
+// The old version is destroyed by whichever thread drops the last pin, so
+// a swap never waits for requests in flight.
+template <typename T>
+class Versioned {
+   public:
+    using Snapshot = std::shared_ptr<const T>;
+
+    explicit Versioned(Snapshot initial);
+
+    Versioned(const Versioned&) = delete;
+    Versioned& operator=(const Versioned&) = delete;
+
+    Snapshot Acquire() const;
+
+    // Returns the version that was current until now.
+    Snapshot Publish(Snapshot next);
+
+   private:
+    // Accessed only through the std::atomic_* shared_ptr overloads.
+    Snapshot current_;
+};
+
+template <typename T>
+Versioned<T>::Versioned(Snapshot initial) : current_(std::move(initial)) {}
+
+template <typename T>
+typename Versioned<T>::Snapshot Versioned<T>::Acquire() const {
+    return std::atomic_load_explicit(&current_, std::memory_order_acquire);
+}
+
+template <typename T>
+typename Versioned<T>::Snapshot Versioned<T>::Publish(Snapshot next) {
+    return std::atomic_exchange_explicit(&current_, std::move(next),
+                                         std::memory_order_acq_rel);
+}
+
+}  // namespace trc
@@ -0,0 +1,281 @@
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "../src/json.h"
+#include "../src/json_reader.h"
+#include "../src/request_handler.h"
+#include "../src/transport_catalogue.h"
+#include "test_framework.h"
+
+namespace trc {
+
+namespace test {
+
+using namespace std;
+
+class CatalogueBuilder {
+   public:
+    void operator()() {
+        RUN_TEST(TestPendingDistance);
+        RUN_TEST(TestUnknownStops);
+        RUN_TEST(TestReplacedBus);
+        RUN_TEST(TestOrderDoesNotMatter);
+        RUN_TEST(TestCountBaseRequests);
+    }
+
+   private:
+    using BaseRequest = variant<io::AddStopRequest, io::AddBusRequest>;
+
+    static vector<BaseRequest> MakeRequests(mt19937& generator) {
+        constexpr int stop_count = 20;
+
+        uniform_real_distribution<double> lat(55.5, 56.0);
+        uniform_real_distribution<double> lng(37.3, 37.9);
+        uniform_int_distribution<int> stop(0, stop_count - 1);
+        uniform_int_distribution<int> distance(500, 5000);
+        uniform_int_distribution<int> small(0, 4);
+
+        vector<BaseRequest> requests;
+
+        for (int i = 0; i < stop_count; ++i) {
+            io::AddStopRequest request{"S" + to_string(i), lat(generator),
+                                       lng(generator), {}};
+            for (int j = small(generator); j > 0; --j) {
+                request.road_distances["S" + to_string(stop(generator))] =
+                    distance(generator);
+            }
+            requests.push_back(move(request));
+        }
+
+        // Routes visit distinct stops, so that none has zero length.
+        vector<int> route(stop_count);
+        iota(route.begin(), route.end(), 0);
+
+        for (int i = 0; i < 10; ++i) {
+            io::AddBusRequest request{"B" + to_string(i), {}, i % 2 == 0};
+            shuffle(route.begin(), route.end(), generator);
+            for (int j = small(generator) + 2; j > 0; --j) {
+                request.stops.push_back("S" + to_string(route[j]));
+            }
+            if (request.is_roundtrip) {
+                request.stops.push_back(request.stops.front());
+            }
+            requests.push_back(move(request));
+        }
+
+        return requests;
+    }
+
+    static TransportCatalogue Build(const vector<BaseRequest>& requests) {
+        rh::CatalogueBuilder builder;
+
+        for (const auto& request : requests) {
+            if (holds_alternative<io::AddStopRequest>(request)) {
+                builder.AddStop(get<io::AddStopRequest>(request));
+            } else {
+                builder.AddBus(
+                    io::AddBusRequest(get<io::AddBusRequest>(request)));
+            }
+        }
+
+        return builder.Build();
+    }
+
+    static map<pair<string, string>, double> GetDistances(
+        const TransportCatalogue& catalogue) {
+        map<pair<string, string>, double> distances;
+
+        catalogue.GetDistances().ForEach(
+            [&](StopId from, StopId to, double distance) {
+                distances[{string(catalogue.GetStops()[from].name),
+                           string(catalogue.GetStops()[to].name)}] = distance;
+            });
+
+        return distances;
+    }
+
+    static vector<string> GetBusNames(const TransportCatalogue& catalogue,
+                                      const string& stop) {
+        const auto bus_names = catalogue.GetStopInfo(stop);
+
+        vector<string> names;
+        for (const auto name : *bus_names) {
+            names.emplace_back(name);
+        }
+        return names;
+    }
+
+    // A distance to a stop that comes later waits for it.
+    static void TestPendingDistance() {
+        const TransportCatalogue catalogue =
+            Build({io::AddBusRequest{"1", {"A", "B"}, false},
+                   io::AddStopRequest{"A", 55.6, 37.6, {{"B", 1200.0}}},
+                   io::AddStopRequest{"B", 55.61, 37.6, {}}});
+
+        const auto bus_info = catalogue.GetBusInfo("1");
+        ASSERT(bus_info.has_value());
+        ASSERT_EQUAL(bus_info->route_length, 2400.0);
+        ASSERT_EQUAL(bus_info->stop_count, 3u);
+        ASSERT_EQUAL(bus_info->unique_stop_count, 2u);
+    }
+
+    static void TestUnknownStops() {
+        for (const auto& requests : vector<vector<BaseRequest>>{
+                 {io::AddStopRequest{"A", 55.6, 37.6, {{"C", 100.0}}}},
+                 {io::AddStopRequest{"A", 55.6, 37.6, {}},
+                  io::AddBusRequest{"1", {"A", "C"}, false}}}) {
+            bool is_rejected = false;
+            try {
+                Build(requests);
+            } catch (const invalid_argument&) {
+                is_rejected = true;
+            }
+            ASSERT(is_rejected);
+        }
+    }
+
+    static vector<string> GetListedStopNames(
+        const TransportCatalogue& catalogue, const string& bus) {
+        vector<string> names;
+        for (const Stop* stop : catalogue.GetListedStops(
+                 catalogue.GetBuses()[*catalogue.FindBusId(bus)])) {
+            names.emplace_back(stop->name);
+        }
+        return names;
+    }
+
+    // A bus added again under the same name leaves nothing of its earlier
+    // route behind, and the routes stored after it stay intact.
+    static void TestReplacedBus() {
+        TransportCatalogue catalogue;
+        for (const string& name : {"A"s, "B"s, "C"s, "D"s}) {
+            catalogue.AddStop(Stop{0, name, {55.6 + name[0] / 100.0, 37.6}});
+        }
+        catalogue.AddDistance("A", "B", 1000.0);
+        catalogue.AddDistance("B", "C", 2000.0);
+        catalogue.AddDistance("C", "D", 3000.0);
+
+        catalogue.AddBus("1", {"A", "B"}, false);
+        catalogue.AddBus("2", {"C", "D"}, false);
+        catalogue.AddBus("1", {"B", "C", "D"}, true);
+
+        ASSERT(GetBusNames(catalogue, "A").empty());
+        ASSERT(GetBusNames(catalogue, "B") == vector<string>{"1"s});
+        ASSERT(GetBusNames(catalogue, "C") == (vector<string>{"1"s, "2"s}));
+        ASSERT(GetBusNames(catalogue, "D") == (vector<string>{"1"s, "2"s}));
+
+        ASSERT_EQUAL(catalogue.GetBuses().size(), 2u);
+        ASSERT_EQUAL(catalogue.GetBusInfo("1")->route_length, 5000.0);
+        ASSERT_EQUAL(catalogue.GetBusInfo("1")->stop_count, 3u);
+        ASSERT(GetListedStopNames(catalogue, "1") ==
+               (vector<string>{"B"s, "C"s, "D"s}));
+        ASSERT(GetListedStopNames(catalogue, "2") ==
+               (vector<string>{"C"s, "D"s}));
+    }
+
+    // Stops and buses interleaved in any order build the catalogue that
+    // stops first, then buses, build.
+    static void TestOrderDoesNotMatter() {
+        mt19937 generator(49);
+
+        for (int i = 0; i < 20; ++i) {
+            vector<BaseRequest> requests = MakeRequests(generator);
+            const TransportCatalogue expected = Build(requests);
+
+            shuffle(requests.begin(), requests.end(), generator);
+            const TransportCatalogue actual = Build(requests);
+
+            ASSERT(GetDistances(actual) == GetDistances(expected));
+
+            for (const auto& request : requests) {
+                if (const auto* stop = get_if<io::AddStopRequest>(&request)) {
+                    ASSERT(GetBusNames(actual, stop->name) ==
+                           GetBusNames(expected, stop->name));
+                    continue;
+                }
+
+                const string& name = get<io::AddBusRequest>(request).name;
+                const auto actual_info = actual.GetBusInfo(name);
+                const auto expected_info = expected.GetBusInfo(name);
+
+                ASSERT_EQUAL(actual_info->stop_count,
+                             expected_info->stop_count);
+                ASSERT_EQUAL(actual_info->unique_stop_count,
+                             expected_info->unique_stop_count);
+                ASSERT_EQUAL(actual_info->route_length,
+                             expected_info->route_length);
+                ASSERT_EQUAL(actual_info->curvature, expected_info->curvature);
+            }
+        }
+    }
+
+    // Counts from the text match the parsed requests; keys outside
+    // base_requests and names that look like keys are not counted.
+    static void TestCountBaseRequests() {
+        mt19937 generator(490);
+        const vector<BaseRequest> requests = MakeRequests(generator);
+
+        json::Array base_requests;
+        io::BaseRequestCounts expected;
+
+        for (const auto& request : requests) {
+            if (const auto* stop = get_if<io::AddStopRequest>(&request)) {
+                json::Dict distances;
+                for (const auto& [to, distance] : stop->road_distances) {
+                    distances[to] = distance;
+                }
+                base_requests.push_back(json::Dict{
+                    {"type", "Stop"s},
+                    {"name", stop->name},
+                    {"latitude", stop->latitude},
+                    {"longitude", stop->longitude},
+                    {"road_distances", move(distances)}});
+
+                ++expected.stop_count;
+                expected.distance_count += stop->road_distances.size();
+            } else {
+                const auto& bus = get<io::AddBusRequest>(request);
+                json::Array stops(bus.stops.begin(), bus.stops.end());
+                base_requests.push_back(json::Dict{
+                    {"type", "Bus"s},
+                    {"name", "stops\":"s},
+                    {"stops", move(stops)},
+                    {"is_roundtrip", bus.is_roundtrip}});
+
+                ++expected.bus_count;
+                expected.route_stop_count += bus.stops.size();
+            }
+        }
+
+        const json::Dict root{
+            {"base_requests", move(base_requests)},
+            {"stat_requests",
+             json::Array{json::Dict{{"type", "NearbyStops"s},
+                                    {"latitude", 55.6},
+                                    {"stops", json::Array{"S1"s}}}}}};
+
+        ostringstream text;
+        json::Print(json::Document(root), text);
+
+        const io::BaseRequestCounts counts =
+            io::CountBaseRequests(text.str());
+
+        ASSERT_EQUAL(counts.stop_count, expected.stop_count);
+        ASSERT_EQUAL(counts.bus_count, expected.bus_count);
+        ASSERT_EQUAL(counts.route_stop_count, expected.route_stop_count);
+        ASSERT_EQUAL(counts.distance_count, expected.distance_count);
+    }
+};
+
+}  // namespace test
+}  // namespace trc
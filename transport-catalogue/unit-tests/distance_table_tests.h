@@ -0,0 +1,107 @@
+#pragma once
+
+#include <map>
+#include <random>
+#include <utility>
+
+#include "../src/distance_table.h"
+#include "test_framework.h"
+
+namespace trc {
+
+namespace test {
+
+using namespace std;
+
+class DistanceTable {
+   public:
+    void operator()() {
+        RUN_TEST(TestEmptyTable);
+        RUN_TEST(TestDirectedPairs);
+        RUN_TEST(TestMatchesMap);
+    }
+
+   private:
+    using Distances = map<pair<StopId, StopId>, double>;
+
+    static void AssertSame(const trc::DistanceTable& table,
+                           const Distances& expected, StopId stop_count) {
+        ASSERT_EQUAL(table.GetSize(), expected.size());
+
+        for (StopId from = 0; from < stop_count; ++from) {
+            for (StopId to = 0; to < stop_count; ++to) {
+                const auto it = expected.find({from, to});
+                const auto distance = table.Find(from, to);
+
+                ASSERT_EQUAL(distance.has_value(), it != expected.end());
+                if (distance) {
+                    ASSERT_EQUAL(*distance, it->second);
+                }
+            }
+        }
+
+        Distances visited;
+        table.ForEach([&](StopId from, StopId to, double distance) {
+            ASSERT(visited.emplace(pair{from, to}, distance).second);
+        });
+        ASSERT(visited == expected);
+    }
+
+    static void TestEmptyTable() {
+        trc::DistanceTable table;
+
+        ASSERT_EQUAL(table.GetSize(), 0u);
+        ASSERT(!table.Find(0, 0));
+
+        table.ShrinkToFit();
+        ASSERT(!table.Find(1, 2));
+    }
+
+    static void TestDirectedPairs() {
+        trc::DistanceTable table;
+        table.Set(1, 2, 100.0);
+
+        ASSERT_EQUAL(*table.Find(1, 2), 100.0);
+        ASSERT(!table.Find(2, 1));
+
+        table.Set(1, 2, 150.0);
+        ASSERT_EQUAL(table.GetSize(), 1u);
+        ASSERT_EQUAL(*table.Find(1, 2), 150.0);
+    }
+
+    // Overwrites, growth, Reserve and ShrinkToFit all keep the contents.
+    static void TestMatchesMap() {
+        constexpr StopId stop_count = 60;
+
+        mt19937 generator(31);
+        uniform_int_distribution<StopId> stop(0, stop_count - 1);
+        uniform_int_distribution<int> distance(1, 10000);
+
+        trc::DistanceTable table;
+        Distances expected;
+
+        table.Reserve(100);
+        for (int i = 0; i < 2000; ++i) {
+            const StopId from = stop(generator);
+            const StopId to = stop(generator);
+            const double value = distance(generator);
+
+            table.Set(from, to, value);
+            expected[{from, to}] = value;
+
+            if (i % 500 == 0) {
+                AssertSame(table, expected, stop_count);
+            }
+        }
+        AssertSame(table, expected, stop_count);
+
+        table.ShrinkToFit();
+        AssertSame(table, expected, stop_count);
+
+        table.Reserve(4 * expected.size());
+        AssertSame(table, expected, stop_count);
+    }
+};
+
+}  // namespace test
+}  // namespace trc
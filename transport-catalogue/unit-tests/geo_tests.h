@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "../src/geo.h"
+#include "test_framework.h"
+
+namespace trc {
+
+namespace test {
+
+using namespace std;
+
+class Geo {
+   public:
+    void operator()() {
+        RUN_TEST(TestSameAndAntimeridianPoints);
+        RUN_TEST(TestMeridianArcs);
+        RUN_TEST(TestMatchesReference);
+        RUN_TEST(TestClosePoints);
+    }
+
+   private:
+    // Relative error bound that geo.h gives away from antipodal points.
+    static constexpr double MAX_RELATIVE_ERROR = 1e-13;
+
+    // Haversine distance from the library sin, cos and asin in long
+    // double, with the same degree-to-radian factor as the kernel.
+    static double ComputeReference(geo::Coordinates from, geo::Coordinates to) {
+        const long double dr = geo::DEGREES_TO_RADIANS;
+
+        long double lng_difference =
+            abs(static_cast<long double>(from.lng) - to.lng);
+        lng_difference = min(lng_difference, 360 - lng_difference);
+
+        const long double lat_sine =
+            sin((static_cast<long double>(to.lat) - from.lat) * dr / 2);
+        const long double lng_sine = sin(lng_difference * dr / 2);
+
+        const long double haversine =
+            lat_sine * lat_sine + cos(from.lat * dr) * cos(to.lat * dr) *
+                                      lng_sine * lng_sine;
+
+        return static_cast<double>(2 * geo::EARTH_RADIUS *
+                                   asin(sqrt(min(haversine, 1.0L))));
+    }
+
+    static double ComputeDistance(geo::Coordinates from, geo::Coordinates to) {
+        return geo::ComputeDistance(geo::ToTrigCoordinates(from),
+                                    geo::ToTrigCoordinates(to));
+    }
+
+    static void AssertClose(double actual, double expected) {
+        ASSERT(abs(actual - expected) <= MAX_RELATIVE_ERROR * expected);
+    }
+
+    static void TestSameAndAntimeridianPoints() {
+        ASSERT_EQUAL(ComputeDistance({55.6, 37.6}, {55.6, 37.6}), 0.0);
+        ASSERT_EQUAL(ComputeDistance({0.0, 180.0}, {0.0, -180.0}), 0.0);
+
+        AssertClose(ComputeDistance({10.0, 179.5}, {10.0, -179.5}),
+                    ComputeReference({10.0, 179.5}, {10.0, -179.5}));
+    }
+
+    // Along a meridian the distance is the latitude difference as an arc,
+    // which checks the polynomial sine alone for half angles up to 45
+    // degrees.
+    static void TestMeridianArcs() {
+        for (int i = 1; i <= 900; ++i) {
+            const double lat_difference = i / 10.0;
+            const double expected =
+                lat_difference * geo::DEGREES_TO_RADIANS * geo::EARTH_RADIUS;
+
+            AssertClose(ComputeDistance({-45.0, 12.0},
+                                        {-45.0 + lat_difference, 12.0}),
+                        expected);
+        }
+    }
+
+    // Random pairs over the globe, both one at a time and through the
+    // batch kernel, short of nearly antipodal ones.
+    static void TestMatchesReference() {
+        mt19937 generator(46);
+        uniform_real_distribution<double> lat(-89.0, 89.0);
+        uniform_real_distribution<double> lng(-180.0, 180.0);
+
+        vector<geo::Coordinates> from;
+        vector<geo::Coordinates> to;
+        while (from.size() < 20000) {
+            const geo::Coordinates a{lat(generator), lng(generator)};
+            const geo::Coordinates b{lat(generator), lng(generator)};
+
+            if (ComputeReference(a, b) <
+                170 * geo::DEGREES_TO_RADIANS * geo::EARTH_RADIUS) {
+                from.push_back(a);
+                to.push_back(b);
+            }
+        }
+
+        vector<geo::TrigCoordinates> trig_from;
+        vector<geo::TrigCoordinates> trig_to;
+        for (size_t i = 0; i < from.size(); ++i) {
+            trig_from.push_back(geo::ToTrigCoordinates(from[i]));
+            trig_to.push_back(geo::ToTrigCoordinates(to[i]));
+        }
+
+        vector<double> distances(from.size());
+        geo::ComputeDistances(trig_from.data(), trig_to.data(), from.size(),
+                              distances.data());
+
+        for (size_t i = 0; i < from.size(); ++i) {
+            const double expected = ComputeReference(from[i], to[i]);
+
+            AssertClose(distances[i], expected);
+            ASSERT_EQUAL(ComputeDistance(from[i], to[i]), distances[i]);
+        }
+    }
+
+    // Meters apart, where the acos form loses digits.
+    static void TestClosePoints() {
+        mt19937 generator(460);
+        uniform_real_distribution<double> lat(55.5, 56.0);
+        uniform_real_distribution<double> lng(37.3, 37.9);
+        uniform_real_distribution<double> offset(-1e-4, 1e-4);
+
+        for (int i = 0; i < 10000; ++i) {
+            const geo::Coordinates from{lat(generator), lng(generator)};
+            const geo::Coordinates to{from.lat + offset(generator),
+                                      from.lng + offset(generator)};
+
+            AssertClose(ComputeDistance(from, to), ComputeReference(from, to));
+        }
+    }
+};
+
+}  // namespace test
+}  // namespace trc
@@ -0,0 +1,578 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "../src/json.h"
+#include "test_framework.h"
+
+namespace trc {
+
+namespace test {
+
+using namespace std;
+
+class Json {
+   public:
+    void operator()() {
+        RUN_TEST(TestNumbers);
+        RUN_TEST(TestMalformedNumbers);
+        RUN_TEST(TestEscapes);
+        RUN_TEST(TestMalformedStrings);
+        RUN_TEST(TestDuplicateKeys);
+        RUN_TEST(TestTruncatedInput);
+        RUN_TEST(TestStreaming);
+        RUN_TEST(TestRandomDocuments);
+        RUN_TEST(TestMatchesStreamParser);
+        RUN_TEST(TestChunkedInput);
+        RUN_TEST(TestArrayPrinter);
+    }
+
+   private:
+    // The stream parser json::Load used before it parsed from a buffer,
+    // kept as the reference for what is accepted and what it is read as.
+    class StreamParser {
+       public:
+        static json::Node LoadNode(istream& input) {
+            char c;
+            if (!(input >> c)) {
+                throw json::ParsingError("Unexpected EOF"s);
+            }
+            switch (c) {
+                case '[':
+                    return LoadArray(input);
+                case '{':
+                    return LoadDict(input);
+                case '"':
+                    return LoadString(input);
+                case 't':
+                    [[fallthrough]];
+                case 'f':
+                    input.putback(c);
+                    return LoadBool(input);
+                case 'n':
+                    input.putback(c);
+                    return LoadNull(input);
+                default:
+                    input.putback(c);
+                    return LoadNumber(input);
+            }
+        }
+
+       private:
+        static string LoadLiteral(istream& input) {
+            string s;
+            while (isalpha(input.peek())) {
+                s.push_back(static_cast<char>(input.get()));
+            }
+            return s;
+        }
+
+        static json::Node LoadArray(istream& input) {
+            json::Array result;
+
+            for (char c; input >> c && c != ']';) {
+                if (c != ',') {
+                    input.putback(c);
+                }
+                result.push_back(LoadNode(input));
+            }
+            if (!input) {
+                throw json::ParsingError("Array parsing error"s);
+            }
+            return result;
+        }
+
+        static json::Node LoadDict(istream& input) {
+            json::Dict dict;
+
+            for (char c; input >> c && c != '}';) {
+                if (c == '"') {
+                    string key = LoadString(input).AsString();
+                    if (!(input >> c && c == ':') || dict.count(key)) {
+                        throw json::ParsingError("Bad dict entry"s);
+                    }
+                    dict.emplace(move(key), LoadNode(input));
+                } else if (c != ',') {
+                    throw json::ParsingError("Bad dict separator"s);
+                }
+            }
+            if (!input) {
+                throw json::ParsingError("Dictionary parsing error"s);
+            }
+            return dict;
+        }
+
+        static json::Node LoadString(istream& input) {
+            auto it = istreambuf_iterator<char>(input);
+            const auto end = istreambuf_iterator<char>();
+            string s;
+
+            for (; it != end && *it != '"'; ++it) {
+                if (*it == '\\') {
+                    if (++it == end) {
+                        break;
+                    }
+                    switch (*it) {
+                        case 'n':
+                            s.push_back('\n');
+                            break;
+                        case 't':
+                            s.push_back('\t');
+                            break;
+                        case 'r':
+                            s.push_back('\r');
+                            break;
+                        case '"':
+                            [[fallthrough]];
+                        case '\\':
+                            s.push_back(*it);
+                            break;
+                        default:
+                            throw json::ParsingError("Bad escape"s);
+                    }
+                } else if (*it == '\n' || *it == '\r') {
+                    throw json::ParsingError("Unexpected end of line"s);
+                } else {
+                    s.push_back(*it);
+                }
+            }
+            if (it == end) {
+                throw json::ParsingError("String parsing error"s);
+            }
+            ++it;
+
+            return s;
+        }
+
+        static json::Node LoadBool(istream& input) {
+            const string literal = LoadLiteral(input);
+            if (literal != "true"sv && literal != "false"sv) {
+                throw json::ParsingError("Bad bool"s);
+            }
+            return literal == "true"sv;
+        }
+
+        static json::Node LoadNull(istream& input) {
+            if (LoadLiteral(input) != "null"sv) {
+                throw json::ParsingError("Bad null"s);
+            }
+            return nullptr;
+        }
+
+        static json::Node LoadNumber(istream& input) {
+            string number;
+
+            const auto read_char = [&] {
+                number += static_cast<char>(input.get());
+            };
+            const auto read_digits = [&] {
+                if (!isdigit(input.peek())) {
+                    throw json::ParsingError("A digit is expected"s);
+                }
+                while (isdigit(input.peek())) {
+                    read_char();
+                }
+            };
+
+            if (input.peek() == '-') {
+                read_char();
+            }
+            if (input.peek() == '0') {
+                read_char();
+            } else {
+                read_digits();
+            }
+
+            bool is_int = true;
+            if (input.peek() == '.') {
+                read_char();
+                read_digits();
+                is_int = false;
+            }
+            if (const int c = input.peek(); c == 'e' || c == 'E') {
+                read_char();
+                if (const int sign = input.peek(); sign == '+' || sign == '-') {
+                    read_char();
+                }
+                read_digits();
+                is_int = false;
+            }
+
+            try {
+                if (is_int) {
+                    try {
+                        return stoi(number);
+                    } catch (...) {
+                    }
+                }
+                return stod(number);
+            } catch (...) {
+                throw json::ParsingError("Bad number"s);
+            }
+        }
+    };
+
+    // Hands text out at most chunk_size characters at a time, as a pipe
+    // gives what has been written so far.
+    class ChunkedBuffer : public streambuf {
+       public:
+        ChunkedBuffer(string text, size_t chunk_size)
+            : text_(move(text)), chunk_size_(chunk_size) {
+            setg(text_.data(), text_.data(), text_.data());
+        }
+
+        // Characters taken by the reader so far.
+        size_t GetConsumed() const { return gptr() - text_.data(); }
+
+       protected:
+        int_type underflow() override {
+            if (egptr() == text_.data() + text_.size()) {
+                return traits_type::eof();
+            }
+            const size_t size = min<size_t>(
+                chunk_size_, text_.data() + text_.size() - egptr());
+            setg(text_.data(), egptr(), egptr() + size);
+            return traits_type::to_int_type(*gptr());
+        }
+
+       private:
+        string text_;
+        size_t chunk_size_;
+    };
+
+    // The buffer parser and the stream parser both reject text, or both
+    // read it as the same node.
+    static bool IsParsedAlike(const string& text) {
+        optional<json::Node> expected;
+        try {
+            istringstream input(text);
+            expected = StreamParser::LoadNode(input);
+        } catch (const json::ParsingError&) {
+        }
+
+        try {
+            const json::Node node = Parse(text);
+            return expected && node == *expected;
+        } catch (const json::ParsingError&) {
+            return !expected;
+        }
+    }
+
+    static json::Node Parse(string_view text) {
+        return json::Load(text).GetRoot();
+    }
+
+    // The parsed node, or nothing if input is rejected.
+    template <typename Input>
+    static optional<json::Node> TryLoad(Input&& input) {
+        try {
+            return json::Load(input).GetRoot();
+        } catch (const json::ParsingError&) {
+            return nullopt;
+        }
+    }
+
+    static bool IsRejected(string_view text) {
+        try {
+            json::Load(text);
+        } catch (const json::ParsingError&) {
+            return true;
+        }
+        return false;
+    }
+
+    static string ToString(const json::Node& node) {
+        ostringstream output;
+        json::Print(json::Document(node), output);
+        return output.str();
+    }
+
+    static void TestNumbers() {
+        ASSERT(Parse("0") == json::Node(0));
+        ASSERT(Parse("-0") == json::Node(0));
+        ASSERT(Parse("42") == json::Node(42));
+        ASSERT(Parse("-17") == json::Node(-17));
+        ASSERT(Parse("2147483647") == json::Node(2147483647));
+        // Ints out of range are read as doubles.
+        ASSERT(Parse("2147483648") == json::Node(2147483648.0));
+        ASSERT(Parse("-3.25") == json::Node(-3.25));
+        ASSERT(Parse("0.5") == json::Node(0.5));
+        ASSERT(Parse("1e3") == json::Node(1000.0));
+        ASSERT(Parse("1E-2") == json::Node(0.01));
+        ASSERT(Parse("2.5e+1") == json::Node(25.0));
+        ASSERT(Parse(" \t\r\n7") == json::Node(7));
+    }
+
+    static void TestMalformedNumbers() {
+        for (const string_view text :
+             {"-"sv, "--1"sv, "+1"sv, ".5"sv, "1."sv, "1.e3"sv,
+              "1e"sv, "1e+"sv, "-a"sv}) {
+            ASSERT(IsRejected(text));
+        }
+    }
+
+    static void TestEscapes() {
+        ASSERT(Parse(R"("a\nb\tc\rd\"e\\f")") ==
+               json::Node("a\nb\tc\rd\"e\\f"s));
+        ASSERT(Parse(R"("")") == json::Node(""s));
+        ASSERT(Parse(R"("\\")") == json::Node("\\"s));
+
+        const string text = "line\none \"quoted\" \\ back\r"s;
+        ASSERT(Parse(ToString(json::Node(text))) == json::Node(text));
+    }
+
+    static void TestMalformedStrings() {
+        for (const string_view text :
+             {R"("\x")"sv, "\"a\nb\""sv, "\"a\rb\""sv,
+              R"("open)"sv, R"("\)"sv}) {
+            ASSERT(IsRejected(text));
+        }
+    }
+
+    static void TestDuplicateKeys() {
+        ASSERT(IsRejected(R"({"a": 1, "a": 2})"));
+        ASSERT(IsRejected(R"({"b": {"a": 1, "c": 2, "a": 3}})"));
+        ASSERT(Parse(R"({"a": {"a": 1}})") ==
+               json::Node(json::Dict{{"a", json::Dict{{"a", 1}}}}));
+
+        const auto ignore = [](json::Node, const json::Dict&) {};
+        bool is_rejected = false;
+        try {
+            json::LoadStreaming(R"({"s": [], "s": []})", "s", ignore);
+        } catch (const json::ParsingError&) {
+            is_rejected = true;
+        }
+        ASSERT(is_rejected);
+    }
+
+    // Every proper prefix of a document is rejected, not read as a shorter
+    // document.
+    static void TestTruncatedInput() {
+        const string text =
+            R"({"a": [1, -2.5, true, false, null, "s\"t"], "b": {"c": {}}})";
+        ASSERT(!IsRejected(text));
+
+        for (size_t size = 0; size < text.size(); ++size) {
+            ASSERT(IsRejected(string_view(text).substr(0, size)));
+        }
+    }
+
+    static void TestStreaming() {
+        json::Array elements;
+        json::Dict preceding;
+
+        const json::Document document = json::LoadStreaming(
+            R"({"a": 1, "s": [{"x": 1}, 2, [3]], "b": "after"})", "s",
+            [&](json::Node element, const json::Dict& dict) {
+                elements.push_back(move(element));
+                preceding = dict;
+            });
+
+        ASSERT(elements == (json::Array{json::Dict{{"x", 1}}, 2,
+                                        json::Array{3}}));
+        ASSERT(preceding == (json::Dict{{"a", 1}}));
+        ASSERT(document.GetRoot() ==
+               json::Node(json::Dict{{"a", 1}, {"b", "after"s}}));
+
+        const auto ignore = [](json::Node, const json::Dict&) {};
+        for (const string_view text :
+             {R"([])"sv, R"({"s": {}})"sv, R"({"s": [1, 2)"sv}) {
+            bool is_rejected = false;
+            try {
+                json::LoadStreaming(text, "s", ignore);
+            } catch (const json::ParsingError&) {
+                is_rejected = true;
+            }
+            ASSERT(is_rejected);
+        }
+    }
+
+    // Doubles are eighths so that printing them loses nothing; they are
+    // never whole, which would print as ints.
+    static json::Node MakeNode(mt19937& generator, int depth) {
+        uniform_int_distribution<int> kind(0, depth > 0 ? 7 : 5);
+        uniform_int_distribution<int> number(-1000, 1000);
+        uniform_int_distribution<int> size(0, 4);
+        uniform_int_distribution<int> letter(0, 6);
+
+        const auto make_string = [&] {
+            string s;
+            for (int i = size(generator); i > 0; --i) {
+                s += "ab\n\"\\\r "[letter(generator)];
+            }
+            return s;
+        };
+
+        switch (kind(generator)) {
+            case 0:
+                return nullptr;
+            case 1:
+                return number(generator) % 2 == 0;
+            case 2:
+                return number(generator);
+            case 3:
+                return number(generator) + 0.25 * size(generator) + 0.125;
+            case 4:
+                [[fallthrough]];
+            case 5:
+                return make_string();
+            case 6: {
+                json::Array array;
+                for (int i = size(generator); i > 0; --i) {
+                    array.push_back(MakeNode(generator, depth - 1));
+                }
+                return array;
+            }
+            default: {
+                json::Dict dict;
+                for (int i = size(generator); i > 0; --i) {
+                    dict[make_string()] = MakeNode(generator, depth - 1);
+                }
+                return dict;
+            }
+        }
+    }
+
+    // Printed random documents read back the same through every entry point.
+    static void TestRandomDocuments() {
+        mt19937 generator(48);
+
+        for (int i = 0; i < 500; ++i) {
+            const json::Node node = MakeNode(generator, 4);
+            const string text = ToString(node);
+
+            ASSERT(Parse(text) == node);
+
+            istringstream input(text);
+            ASSERT(json::Load(input).GetRoot() == node);
+
+            json::Array elements;
+            json::Dict preceding;
+            const json::Node root =
+                json::Dict{{"a", node}, {"s", json::Array{node, node}}};
+
+            istringstream streamed_input(ToString(root));
+            const json::Document document = json::LoadStreaming(
+                streamed_input, "s",
+                [&](json::Node element, const json::Dict& dict) {
+                    elements.push_back(move(element));
+                    preceding = dict;
+                });
+
+            ASSERT(elements == (json::Array{node, node}));
+            ASSERT(preceding == (json::Dict{{"a", node}}));
+            ASSERT(document.GetRoot() == json::Node(json::Dict{{"a", node}}));
+        }
+    }
+
+    // Random fragments of JSON tokens, and printed documents with a
+    // character dropped, swapped or cut off, mostly malformed.
+    static void TestMatchesStreamParser() {
+        mt19937 generator(480);
+
+        const string_view tokens[] = {
+            "{"sv, "}"sv, "["sv, "]"sv, ","sv,   ":"sv,     "\""sv,
+            "\\"sv, "n"sv, "\"k\""sv, "true"sv, "fals"sv, "null"sv, "0"sv,
+            "7"sv, "-"sv, "+"sv,   "."sv,       "e"sv,     " "sv,    "\n"sv,
+            "\t"sv, "1e400"sv, "2147483648"sv, "-0.5"sv, "x"sv};
+        uniform_int_distribution<size_t> token(0, size(tokens) - 1);
+        uniform_int_distribution<int> size(0, 12);
+
+        for (int i = 0; i < 20000; ++i) {
+            string text;
+            for (int j = size(generator); j > 0; --j) {
+                text += tokens[token(generator)];
+            }
+            ASSERT(IsParsedAlike(text));
+        }
+
+        for (int i = 0; i < 2000; ++i) {
+            string text = ToString(MakeNode(generator, 3));
+            uniform_int_distribution<size_t> position(0, text.size() - 1);
+
+            ASSERT(IsParsedAlike(text));
+
+            string dropped = text;
+            dropped.erase(position(generator), 1);
+            ASSERT(IsParsedAlike(dropped));
+
+            string swapped = text;
+            swapped[position(generator)] = tokens[token(generator)][0];
+            ASSERT(IsParsedAlike(swapped));
+
+            ASSERT(IsParsedAlike(text.substr(0, position(generator))));
+        }
+    }
+
+    // Values split anywhere across chunks parse as from a whole buffer, and
+    // streamed elements are handed over before the rest of input is read.
+    static void TestChunkedInput() {
+        mt19937 generator(4800);
+
+        for (int i = 0; i < 300; ++i) {
+            const json::Node node = MakeNode(generator, 3);
+            const string text = ToString(node);
+
+            for (const size_t chunk_size : {1u, 2u, 3u, 7u}) {
+                ChunkedBuffer buffer(text, chunk_size);
+                istream input(&buffer);
+                ASSERT(json::Load(input).GetRoot() == node);
+
+                const string root_text = ToString(json::Dict{
+                    {"a", node}, {"s", json::Array{node, node}}, {"b", 1}});
+                ChunkedBuffer streamed_buffer(root_text, chunk_size);
+                istream streamed_input(&streamed_buffer);
+
+                json::Array elements;
+                json::LoadStreaming(
+                    streamed_input, "s",
+                    [&](json::Node element, const json::Dict&) {
+                        ASSERT(streamed_buffer.GetConsumed() <
+                               root_text.size());
+                        elements.push_back(move(element));
+                    });
+                ASSERT(elements == (json::Array{node, node}));
+            }
+
+            for (size_t size = 0; size < text.size(); ++size) {
+                const string prefix = text.substr(0, size);
+                ChunkedBuffer buffer(prefix, 2);
+                istream input(&buffer);
+                ASSERT(TryLoad(input) == TryLoad(prefix));
+            }
+        }
+    }
+
+    // Elements printed one at a time give what Print gives the whole array.
+    static void TestArrayPrinter() {
+        mt19937 generator(4801);
+        uniform_int_distribution<int> size(0, 4);
+
+        for (int i = 0; i < 200; ++i) {
+            json::Array array;
+            for (int j = size(generator); j > 0; --j) {
+                array.push_back(MakeNode(generator, 3));
+            }
+
+            ostringstream output;
+            json::ArrayPrinter printer(output);
+            for (const json::Node& element : array) {
+                printer.Print(element);
+            }
+            printer.Finish();
+
+            ASSERT_EQUAL(printer.GetSize(), array.size());
+            ASSERT_EQUAL(output.str(), ToString(array));
+        }
+    }
+};
+
+}  // namespace test
+}  // namespace trc
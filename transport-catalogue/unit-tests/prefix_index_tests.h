@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../src/prefix_index.h"
+#include "test_framework.h"
+
+namespace trc {
+
+namespace test {
+
+using namespace std;
+
+class PrefixIndex {
+   public:
+    void operator()() {
+        RUN_TEST(TestEmptyIndex);
+        RUN_TEST(TestFindMatchesBruteForce);
+    }
+
+   private:
+    using Entry = trc::PrefixIndex::Entry;
+
+    static vector<string> MakeNames(mt19937& generator, size_t count) {
+        uniform_int_distribution<size_t> length(1, 5);
+        uniform_int_distribution<size_t> letter(0, 3);
+
+        set<string> names;
+        while (names.size() < count) {
+            string name;
+            for (size_t i = length(generator); i > 0; --i) {
+                name += "ab c"[letter(generator)];
+            }
+            names.insert(move(name));
+        }
+        return {names.begin(), names.end()};
+    }
+
+    // Names starting with prefix, in the order the index must give them.
+    static vector<string_view> Filter(vector<Entry> entries,
+                                      string_view prefix, size_t count,
+                                      bool is_ranked) {
+        sort(entries.begin(), entries.end(),
+             [is_ranked](const Entry& lhs, const Entry& rhs) {
+                 if (is_ranked && lhs.weight != rhs.weight) {
+                     return lhs.weight > rhs.weight;
+                 }
+                 return lhs.name < rhs.name;
+             });
+
+        vector<string_view> names;
+        for (const auto& [name, weight] : entries) {
+            if (names.size() < count &&
+                name.substr(0, prefix.size()) == prefix) {
+                names.push_back(name);
+            }
+        }
+        return names;
+    }
+
+    static vector<string_view> GetNames(const vector<Entry>& entries) {
+        vector<string_view> names;
+        for (const auto& [name, weight] : entries) {
+            names.push_back(name);
+        }
+        return names;
+    }
+
+    static void TestEmptyIndex() {
+        const trc::PrefixIndex index;
+
+        ASSERT(index.Find("", 10).empty());
+        ASSERT(index.FindHeaviest("a", 10).empty());
+    }
+
+    // Weights come from a small range so that ties are common.
+    static void TestFindMatchesBruteForce() {
+        mt19937 generator(45);
+        uniform_int_distribution<uint32_t> weight(0, 4);
+
+        const vector<string> names = MakeNames(generator, 300);
+
+        vector<Entry> entries;
+        for (const string& name : names) {
+            entries.push_back({name, weight(generator)});
+        }
+        shuffle(entries.begin(), entries.end(), generator);
+
+        const trc::PrefixIndex index(entries);
+        ASSERT_EQUAL(index.GetSize(), names.size());
+
+        for (const string_view prefix :
+             {""sv, "a"sv, "b "sv, "ca"sv, "c c"sv, "aaaaa"sv, "d"sv}) {
+            for (const size_t count : {0u, 1u, 3u, 1000u}) {
+                ASSERT(GetNames(index.Find(prefix, count)) ==
+                       Filter(entries, prefix, count, false));
+                ASSERT(GetNames(index.FindHeaviest(prefix, count)) ==
+                       Filter(entries, prefix, count, true));
+            }
+        }
+    }
+};
+
+}  // namespace test
+}  // namespace trc
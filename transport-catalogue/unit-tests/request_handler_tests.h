@@ -0,0 +1,149 @@
+#pragma once
+
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "../src/json.h"
+#include "../src/json_reader.h"
+#include "../src/map_renderer.h"
+#include "../src/network.h"
+#include "../src/request_handler.h"
+#include "../src/transport_catalogue.h"
+#include "test_framework.h"
+
+namespace trc {
+
+namespace test {
+
+using namespace std;
+
+class RequestHandler {
+   public:
+    void operator()() {
+        RUN_TEST(TestMalformedNearbyStops);
+        RUN_TEST(TestMalformedSuggest);
+        RUN_TEST(TestNegativeRoutingLimits);
+    }
+
+   private:
+    // Stops A and B 1 km apart on one linear bus.
+    static unique_ptr<const Network> MakeNetwork() {
+        trc::TransportCatalogue catalogue;
+        catalogue.AddStop(Stop{0, "A", {55.6, 37.6}});
+        catalogue.AddStop(Stop{0, "B", {55.61, 37.6}});
+        catalogue.AddDistance("A", "B", 1000.0);
+        catalogue.AddBus("1", {"A", "B"}, false);
+
+        render::RenderSettings render_settings{
+            200.0, 200.0, 30.0, 14.0, 5.0, 20, {7.0, 15.0}, 18, {7.0, -3.0},
+            "white", 3.0, {"red"}};
+
+        TransportRouter::Settings router_settings;
+        router_settings.bus_wait_time = 2.0;
+        router_settings.bus_velocity = 30.0;
+
+        return make_unique<const Network>(1, move(catalogue),
+                                          move(render_settings),
+                                          router_settings);
+    }
+
+    // Answers stat_requests, a JSON array, and returns the responses.
+    static json::Array Answer(const Network& network,
+                              const string& stat_requests) {
+        istringstream input(R"({"stat_requests": )" + stat_requests + "}");
+        const io::JsonReader json_reader(input);
+
+        ostringstream output;
+        rh::StatRequestHandler(network, output).HandleStatRequests(json_reader);
+
+        return json::Load(output.str()).GetRoot().AsArray();
+    }
+
+    static json::Node MakeError(int id, const string& error_message) {
+        return json::Dict{{io::REQUEST_ID_FIELD, id},
+                          {io::ERROR_MESSAGE_FIELD, error_message}};
+    }
+
+    // A bad request gets its own error and the rest of the batch is still
+    // answered.
+    static void TestMalformedNearbyStops() {
+        const auto network = MakeNetwork();
+
+        const json::Array responses = Answer(*network, R"([
+            {"id": 1, "type": "NearbyStops", "latitude": 55.6,
+             "longitude": 37.6},
+            {"id": 2, "type": "NearbyStops", "latitude": 55.6,
+             "longitude": 37.6, "count": -1},
+            {"id": 3, "type": "NearbyStops", "latitude": "north",
+             "longitude": 37.6, "count": 1},
+            {"id": 4, "type": "NearbyStops", "latitude": 55.6,
+             "longitude": 37.6, "count": 1}
+        ])");
+
+        ASSERT_EQUAL(responses.size(), 4u);
+        ASSERT(responses[0] ==
+               MakeError(1, "NearbyStops request needs a count or a radius"));
+        ASSERT(responses[1] ==
+               MakeError(2, "NearbyStops count must not be negative"));
+        ASSERT(responses[2] == MakeError(3, "Malformed NearbyStops request"));
+
+        const json::Array& stops =
+            responses[3].AsDict().at(io::STOPS_FIELD).AsArray();
+        ASSERT_EQUAL(stops.size(), 1u);
+        ASSERT_EQUAL(stops[0].AsDict().at(io::STOP_NAME_FIELD).AsString(),
+                     "A"s);
+    }
+
+    static void TestMalformedSuggest() {
+        const auto network = MakeNetwork();
+
+        const json::Array responses = Answer(*network, R"([
+            {"id": 1, "type": "Suggest", "prefix": "", "kind": "Train"},
+            {"id": 2, "type": "Suggest", "prefix": "", "count": -1},
+            {"id": 3, "type": "Suggest", "prefix": "", "count": 1}
+        ])");
+
+        ASSERT_EQUAL(responses.size(), 3u);
+        ASSERT(responses[0] ==
+               MakeError(1, "Suggest kind must be Stop or Bus"));
+        ASSERT(responses[1] ==
+               MakeError(2, "Suggest count must not be negative"));
+        ASSERT(responses[2] ==
+               json::Node(json::Dict{{io::NAMES_FIELD, json::Array{"A"s}},
+                                     {io::REQUEST_ID_FIELD, 3}}));
+    }
+
+    static TransportRouter::Settings ParseRoutingSettings(
+        const string& extra_settings) {
+        istringstream input(
+            R"({"routing_settings": {"bus_wait_time": 2, "bus_velocity": 30)" +
+            extra_settings + "}}");
+        return io::JsonReader(input).GetRoutingSettings();
+    }
+
+    // A negative limit would wrap around to no limit at all.
+    static void TestNegativeRoutingLimits() {
+        const TransportRouter::Settings settings = ParseRoutingSettings(
+            R"(, "max_expanded_vertices": 0, "memory_budget_mb": 64)");
+        ASSERT_EQUAL(settings.max_expanded_vertices, 0u);
+        ASSERT_EQUAL(settings.memory_budget_mb, 64u);
+
+        for (const string& extra_settings :
+             {R"(, "max_expanded_vertices": -1)"s,
+              R"(, "memory_budget_mb": -64)"s}) {
+            bool is_rejected = false;
+            try {
+                ParseRoutingSettings(extra_settings);
+            } catch (const invalid_argument&) {
+                is_rejected = true;
+            }
+            ASSERT(is_rejected);
+        }
+    }
+};
+
+}  // namespace test
+}  // namespace trc
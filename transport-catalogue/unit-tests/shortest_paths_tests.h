@@ -0,0 +1,261 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "../src/dijkstra.h"
+#include "../src/graph.h"
+#include "../src/k_shortest_paths.h"
+#include "test_framework.h"
+
+namespace trc {
+
+namespace test {
+
+using namespace std;
+
+class ShortestPaths {
+   public:
+    void operator()() {
+        RUN_TEST(TestDijkstraMatchesFloydWarshall);
+        RUN_TEST(TestDijkstraBans);
+        RUN_TEST(TestVisitReachable);
+        RUN_TEST(TestExpansionLimit);
+        RUN_TEST(TestKShortestPathsMatchesBruteForce);
+    }
+
+   private:
+    using Graph = graph::DirectedWeightedGraph<double>;
+    using VertexId = graph::VertexId;
+    using EdgeId = graph::EdgeId;
+
+    static constexpr double INF = numeric_limits<double>::infinity();
+
+    // Whole weights keep every sum exact.
+    static Graph MakeGraph(mt19937& generator, size_t vertex_count,
+                           size_t edge_count) {
+        uniform_int_distribution<VertexId> vertex(0, vertex_count - 1);
+        uniform_int_distribution<int> weight(1, 10);
+
+        Graph graph(vertex_count);
+        for (size_t i = 0; i < edge_count; ++i) {
+            graph.AddEdge({vertex(generator), vertex(generator),
+                           static_cast<double>(weight(generator))});
+        }
+        return graph;
+    }
+
+    static vector<vector<double>> FloydWarshall(
+        const Graph& graph, const set<VertexId>& banned = {}) {
+        const size_t size = graph.GetVertexCount();
+        vector<vector<double>> distances(size, vector<double>(size, INF));
+
+        for (VertexId vertex = 0; vertex < size; ++vertex) {
+            if (!banned.count(vertex)) {
+                distances[vertex][vertex] = 0.0;
+            }
+        }
+        for (EdgeId id = 0; id < graph.GetEdgeCount(); ++id) {
+            const auto& [from, to, weight] = graph.GetEdge(id);
+            if (!banned.count(from) && !banned.count(to)) {
+                distances[from][to] = min(distances[from][to], weight);
+            }
+        }
+        for (VertexId via = 0; via < size; ++via) {
+            for (VertexId from = 0; from < size; ++from) {
+                for (VertexId to = 0; to < size; ++to) {
+                    distances[from][to] =
+                        min(distances[from][to],
+                            distances[from][via] + distances[via][to]);
+                }
+            }
+        }
+        return distances;
+    }
+
+    // Edges form a walk from `from` to `to` of the given weight.
+    static void AssertPath(const Graph& graph, const vector<EdgeId>& edges,
+                           VertexId from, VertexId to, double weight) {
+        double total = 0.0;
+        VertexId vertex = from;
+
+        for (const EdgeId id : edges) {
+            ASSERT_EQUAL(graph.GetEdge(id).from, vertex);
+            vertex = graph.GetEdge(id).to;
+            total += graph.GetEdge(id).weight;
+        }
+        ASSERT_EQUAL(vertex, to);
+        ASSERT_EQUAL(total, weight);
+    }
+
+    static void TestDijkstraMatchesFloydWarshall() {
+        mt19937 generator(27);
+
+        for (int i = 0; i < 20; ++i) {
+            const Graph graph = MakeGraph(generator, 30, 90);
+            const auto distances = FloydWarshall(graph);
+            graph::Dijkstra<double> dijkstra(graph);
+
+            for (VertexId from = 0; from < 30; ++from) {
+                for (VertexId to = 0; to < 30; ++to) {
+                    const auto route = dijkstra.BuildRoute(from, to);
+
+                    ASSERT_EQUAL(route.has_value(), distances[from][to] < INF);
+                    if (route) {
+                        ASSERT_EQUAL(route->weight, distances[from][to]);
+                        AssertPath(graph, route->edges, from, to,
+                                   route->weight);
+                    }
+                }
+            }
+        }
+    }
+
+    static void TestDijkstraBans() {
+        mt19937 generator(270);
+        const Graph graph = MakeGraph(generator, 20, 60);
+
+        const set<VertexId> banned{3, 7, 11};
+        const auto distances = FloydWarshall(graph, banned);
+
+        graph::Dijkstra<double> dijkstra(graph);
+        for (const VertexId vertex : banned) {
+            dijkstra.BanVertex(vertex);
+        }
+
+        for (VertexId from = 0; from < 20; ++from) {
+            for (VertexId to = 0; to < 20; ++to) {
+                const auto route = dijkstra.BuildRoute(from, to);
+
+                ASSERT_EQUAL(route.has_value(), distances[from][to] < INF);
+                if (route) {
+                    ASSERT_EQUAL(route->weight, distances[from][to]);
+                }
+            }
+        }
+
+        dijkstra.ClearBans();
+        const auto all_distances = FloydWarshall(graph);
+        const auto route = dijkstra.BuildRoute(3, 7);
+        ASSERT_EQUAL(route.has_value(), all_distances[3][7] < INF);
+    }
+
+    static void TestVisitReachable() {
+        mt19937 generator(271);
+        const Graph graph = MakeGraph(generator, 30, 90);
+        const auto distances = FloydWarshall(graph);
+
+        graph::Dijkstra<double> dijkstra(graph);
+
+        for (VertexId from = 0; from < 30; ++from) {
+            set<VertexId> visited;
+            double last_weight = 0.0;
+
+            dijkstra.VisitReachable(from, 12.0,
+                                    [&](VertexId vertex, double weight) {
+                                        ASSERT(weight >= last_weight);
+                                        ASSERT_EQUAL(weight,
+                                                     distances[from][vertex]);
+                                        ASSERT(visited.insert(vertex).second);
+                                        last_weight = weight;
+                                    });
+
+            for (VertexId to = 0; to < 30; ++to) {
+                ASSERT_EQUAL(visited.count(to) > 0,
+                             distances[from][to] <= 12.0);
+            }
+        }
+    }
+
+    static void TestExpansionLimit() {
+        Graph graph(3);
+        graph.AddEdge({0, 1, 1.0});
+        graph.AddEdge({1, 2, 1.0});
+
+        graph::Dijkstra<double> dijkstra(graph);
+        dijkstra.SetExpansionLimit(2);
+
+        ASSERT(!dijkstra.BuildRoute(0, 2));
+        ASSERT(dijkstra.IsLimitReached());
+        ASSERT_EQUAL(dijkstra.GetExpandedVertexCount(), 2u);
+
+        // The limit spans the lifetime of the object.
+        ASSERT(!dijkstra.BuildRoute(0, 0));
+    }
+
+    // Weights of every loop-free path, lightest first.
+    static vector<double> FindAllPathWeights(const Graph& graph,
+                                             VertexId from, VertexId to) {
+        vector<double> weights;
+        vector<bool> on_path(graph.GetVertexCount());
+
+        const auto visit = [&](const auto& self, VertexId vertex,
+                               double weight) -> void {
+            if (vertex == to) {
+                weights.push_back(weight);
+                return;
+            }
+            on_path[vertex] = true;
+            for (const EdgeId id : graph.GetIncidentEdges(vertex)) {
+                const auto& edge = graph.GetEdge(id);
+                if (!on_path[edge.to]) {
+                    self(self, edge.to, weight + edge.weight);
+                }
+            }
+            on_path[vertex] = false;
+        };
+        visit(visit, from, 0.0);
+
+        sort(weights.begin(), weights.end());
+        return weights;
+    }
+
+    // Paths of equal weight may come in any order, so the weights are
+    // compared and the paths are checked to be distinct and loop-free.
+    static void TestKShortestPathsMatchesBruteForce() {
+        mt19937 generator(2700);
+
+        for (int i = 0; i < 50; ++i) {
+            const Graph graph = MakeGraph(generator, 7, 18);
+            const graph::KShortestPaths<double> k_shortest_paths(graph);
+
+            for (VertexId from = 0; from < 7; ++from) {
+                for (VertexId to = 0; to < 7; ++to) {
+                    if (from == to) {
+                        continue;
+                    }
+
+                    const auto result = k_shortest_paths.Find(from, to, 5);
+                    const auto all_weights =
+                        FindAllPathWeights(graph, from, to);
+
+                    ASSERT_EQUAL(result.routes.size(),
+                                 min<size_t>(5, all_weights.size()));
+                    ASSERT(!result.limit_reached);
+
+                    set<vector<EdgeId>> paths;
+                    for (size_t j = 0; j < result.routes.size(); ++j) {
+                        const auto& [weight, edges] = result.routes[j];
+
+                        ASSERT_EQUAL(weight, all_weights[j]);
+                        AssertPath(graph, edges, from, to, weight);
+                        ASSERT(paths.insert(edges).second);
+
+                        set<VertexId> vertices{from};
+                        for (const EdgeId id : edges) {
+                            ASSERT(vertices.insert(graph.GetEdge(id).to)
+                                       .second);
+                        }
+                    }
+                }
+            }
+        }
+    }
+};
+
+}  // namespace test
+}  // namespace trc
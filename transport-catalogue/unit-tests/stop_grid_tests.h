@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "../src/geo.h"
+#include "../src/stop_grid.h"
+#include "test_framework.h"
+
+namespace trc {
+
+namespace test {
+
+using namespace std;
+
+class StopGrid {
+   public:
+    void operator()() {
+        RUN_TEST(TestEmptyGrid);
+        RUN_TEST(TestErase);
+        RUN_TEST(TestFindNearestMatchesBruteForce);
+        RUN_TEST(TestFindWithinMatchesBruteForce);
+    }
+
+   private:
+    struct Point {
+        StopId id;
+        geo::Coordinates coordinates;
+    };
+
+    static vector<Point> MakePoints(mt19937& generator, size_t count) {
+        uniform_real_distribution<double> lat(55.5, 56.0);
+        uniform_real_distribution<double> lng(37.3, 37.9);
+
+        vector<Point> points;
+        for (size_t i = 0; i < count; ++i) {
+            points.push_back(
+                {static_cast<StopId>(i), {lat(generator), lng(generator)}});
+        }
+        return points;
+    }
+
+    // Every stop sorted by distance from center, ties broken by id.
+    static vector<trc::StopGrid::NearbyStop> SortAll(
+        const vector<Point>& points, geo::Coordinates center) {
+        const geo::TrigCoordinates trig_center = geo::ToTrigCoordinates(center);
+
+        vector<trc::StopGrid::NearbyStop> result;
+        for (const auto& [id, coordinates] : points) {
+            const double distance = geo::ComputeDistance(
+                trig_center, geo::ToTrigCoordinates(coordinates));
+            result.push_back({id, distance});
+        }
+
+        sort(result.begin(), result.end(),
+             [](const auto& lhs, const auto& rhs) {
+                 return lhs.distance < rhs.distance ||
+                        (lhs.distance == rhs.distance && lhs.id < rhs.id);
+             });
+        return result;
+    }
+
+    static void AssertSame(const vector<trc::StopGrid::NearbyStop>& actual,
+                           const vector<trc::StopGrid::NearbyStop>& expected) {
+        ASSERT_EQUAL(actual.size(), expected.size());
+        for (size_t i = 0; i < actual.size(); ++i) {
+            ASSERT_EQUAL(actual[i].id, expected[i].id);
+            ASSERT_EQUAL(actual[i].distance, expected[i].distance);
+        }
+    }
+
+    static void TestEmptyGrid() {
+        const trc::StopGrid grid;
+
+        ASSERT_EQUAL(grid.GetSize(), 0u);
+        ASSERT(grid.FindNearest({55.6, 37.6}, 5).empty());
+        ASSERT(grid.FindWithin({55.6, 37.6}, 1000.0).empty());
+    }
+
+    static void TestErase() {
+        trc::StopGrid grid;
+        grid.Insert(0, {55.6, 37.6});
+        grid.Insert(1, {55.6001, 37.6});
+
+        grid.Erase(0, {55.6, 37.6});
+
+        const auto nearest = grid.FindNearest({55.6, 37.6}, 5);
+
+        ASSERT_EQUAL(grid.GetSize(), 1u);
+        ASSERT_EQUAL(nearest.size(), 1u);
+        ASSERT_EQUAL(nearest.front().id, 1u);
+    }
+
+    static void TestFindNearestMatchesBruteForce() {
+        mt19937 generator(38);
+        const vector<Point> points = MakePoints(generator, 3000);
+
+        trc::StopGrid grid;
+        for (const auto& [id, coordinates] : points) {
+            grid.Insert(id, coordinates);
+        }
+
+        uniform_int_distribution<size_t> count(0, 60);
+
+        vector<Point> centers = MakePoints(generator, 30);
+        // Far from every stop, the search has to widen over empty rings.
+        centers.push_back({0, {50.0, 30.0}});
+
+        for (const Point& center : centers) {
+            const size_t k = count(generator);
+
+            auto expected = SortAll(points, center.coordinates);
+            expected.resize(min(k, expected.size()));
+
+            AssertSame(grid.FindNearest(center.coordinates, k), expected);
+        }
+
+        ASSERT_EQUAL(grid.FindNearest({55.6, 37.6}, 5000).size(),
+                     points.size());
+    }
+
+    static void TestFindWithinMatchesBruteForce() {
+        mt19937 generator(380);
+        const vector<Point> points = MakePoints(generator, 3000);
+
+        trc::StopGrid grid;
+        for (const auto& [id, coordinates] : points) {
+            grid.Insert(id, coordinates);
+        }
+
+        uniform_real_distribution<double> radius(0.0, 5000.0);
+
+        for (const Point& center : MakePoints(generator, 30)) {
+            const double r = radius(generator);
+
+            auto expected = SortAll(points, center.coordinates);
+            expected.erase(
+                find_if(expected.begin(), expected.end(),
+                        [r](const auto& stop) { return stop.distance > r; }),
+                expected.end());
+
+            AssertSame(grid.FindWithin(center.coordinates, r), expected);
+        }
+    }
+};
+
+}  // namespace test
+}  // namespace trc
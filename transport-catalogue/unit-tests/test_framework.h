@@ -24,13 +24,14 @@ std::ostream& operator<<(std::ostream& out,
 
 template <typename T1, typename T2>
 std::ostream& operator<<(std::ostream& os, const std::tuple<T1, T2>& tup) {
-    os << get<0>(tup) << ", " << get<1>(tup);
+    os << std::get<0>(tup) << ", " << std::get<1>(tup);
     return os;
 }
 
 template <typename T1, typename T2, typename T3>
 std::ostream& operator<<(std::ostream& os, const std::tuple<T1, T2, T3>& tup) {
-    os << get<0>(tup) << ", " << get<1>(tup) << ", " << get<2>(tup);
+    os << std::get<0>(tup) << ", " << std::get<1>(tup) << ", "
+       << std::get<2>(tup);
     return os;
 }
 
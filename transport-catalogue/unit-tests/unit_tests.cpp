@@ -1,7 +1,36 @@
+#if defined(INPUT_READER) || defined(TRANSPORT_CATALOGUE) || defined(ALL)
 #include "unit_tests.h"
+#endif
 
 #include <iostream>
 
+#if defined(CATALOGUE_BUILDER)
+#include "catalogue_builder_tests.h"
+#endif
+#if defined(DISTANCE_TABLE)
+#include "distance_table_tests.h"
+#endif
+#if defined(GEO)
+#include "geo_tests.h"
+#endif
+#if defined(JSON)
+#include "json_tests.h"
+#endif
+#if defined(PREFIX_INDEX)
+#include "prefix_index_tests.h"
+#endif
+#if defined(REQUEST_HANDLER)
+#include "request_handler_tests.h"
+#endif
+#if defined(SHORTEST_PATHS)
+#include "shortest_paths_tests.h"
+#endif
+#if defined(STOP_GRID)
+#include "stop_grid_tests.h"
+#endif
+#if defined(VERSIONED)
+#include "versioned_tests.h"
+#endif
 #include "test_framework.h"
 
 using namespace trc;
@@ -16,4 +45,40 @@ int main() {
     test::TransportCatalogue TEST_TRANSPORT_CATALOGUE;
     RUN_TEST(TEST_TRANSPORT_CATALOGUE);
 #endif
+#if defined(CATALOGUE_BUILDER)
+    test::CatalogueBuilder TEST_CATALOGUE_BUILDER;
+    RUN_TEST(TEST_CATALOGUE_BUILDER);
+#endif
+#if defined(DISTANCE_TABLE)
+    test::DistanceTable TEST_DISTANCE_TABLE;
+    RUN_TEST(TEST_DISTANCE_TABLE);
+#endif
+#if defined(GEO)
+    test::Geo TEST_GEO;
+    RUN_TEST(TEST_GEO);
+#endif
+#if defined(JSON)
+    test::Json TEST_JSON;
+    RUN_TEST(TEST_JSON);
+#endif
+#if defined(PREFIX_INDEX)
+    test::PrefixIndex TEST_PREFIX_INDEX;
+    RUN_TEST(TEST_PREFIX_INDEX);
+#endif
+#if defined(REQUEST_HANDLER)
+    test::RequestHandler TEST_REQUEST_HANDLER;
+    RUN_TEST(TEST_REQUEST_HANDLER);
+#endif
+#if defined(SHORTEST_PATHS)
+    test::ShortestPaths TEST_SHORTEST_PATHS;
+    RUN_TEST(TEST_SHORTEST_PATHS);
+#endif
+#if defined(STOP_GRID)
+    test::StopGrid TEST_STOP_GRID;
+    RUN_TEST(TEST_STOP_GRID);
+#endif
+#if defined(VERSIONED)
+    test::Versioned TEST_VERSIONED;
+    RUN_TEST(TEST_VERSIONED);
+#endif
 }
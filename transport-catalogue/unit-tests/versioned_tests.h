@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../src/versioned.h"
+#include "test_framework.h"
+
+namespace trc {
+
+namespace test {
+
+using namespace std;
+
+class Versioned {
+   public:
+    void operator()() {
+        RUN_TEST(TestPublishKeepsPinnedVersion);
+        RUN_TEST(TestLastPinDestroysVersion);
+        RUN_TEST(TestReadersDuringPublish);
+    }
+
+   private:
+    // Counts live copies, so that a version freed early or never freed
+    // shows up. A reader that saw a version before it was fully built
+    // would find `half` not matching `number`.
+    struct State {
+        State(int number, atomic<int>& live_count)
+            : number(number), half(number / 2), live_count(live_count) {
+            ++live_count;
+        }
+
+        State(const State&) = delete;
+        State& operator=(const State&) = delete;
+
+        ~State() { --live_count; }
+
+        int number;
+        int half;
+        atomic<int>& live_count;
+    };
+
+    using Holder = trc::Versioned<State>;
+
+    static void TestPublishKeepsPinnedVersion() {
+        atomic<int> live_count = 0;
+        Holder holder(make_shared<const State>(1, live_count));
+
+        const Holder::Snapshot pinned = holder.Acquire();
+        const Holder::Snapshot previous =
+            holder.Publish(make_shared<const State>(2, live_count));
+
+        ASSERT_EQUAL(previous.get(), pinned.get());
+        ASSERT_EQUAL(pinned->number, 1);
+        ASSERT_EQUAL(holder.Acquire()->number, 2);
+        ASSERT_EQUAL(live_count.load(), 2);
+    }
+
+    // Publish does not free the old version; the last reader to drop it
+    // does.
+    static void TestLastPinDestroysVersion() {
+        atomic<int> live_count = 0;
+        Holder holder(make_shared<const State>(1, live_count));
+
+        Holder::Snapshot first_pin = holder.Acquire();
+        Holder::Snapshot second_pin = holder.Acquire();
+
+        holder.Publish(make_shared<const State>(2, live_count));
+        ASSERT_EQUAL(live_count.load(), 2);
+
+        first_pin.reset();
+        ASSERT_EQUAL(live_count.load(), 2);
+
+        second_pin.reset();
+        ASSERT_EQUAL(live_count.load(), 1);
+    }
+
+    // Readers pin versions while a writer keeps publishing. Each reader
+    // sees whole versions that never go back, and every version but the
+    // current one is freed in the end.
+    static void TestReadersDuringPublish() {
+        constexpr int version_count = 20000;
+        constexpr int reader_count = 4;
+
+        atomic<int> live_count = 0;
+        Holder holder(make_shared<const State>(0, live_count));
+        atomic<bool> is_done = false;
+        atomic<bool> is_consistent = true;
+
+        vector<thread> readers;
+        for (int i = 0; i < reader_count; ++i) {
+            readers.emplace_back([&] {
+                int last_number = 0;
+                Holder::Snapshot held = holder.Acquire();
+
+                while (!is_done) {
+                    const Holder::Snapshot pinned = holder.Acquire();
+                    if (pinned->half != pinned->number / 2 ||
+                        pinned->number < last_number ||
+                        held->half != held->number / 2) {
+                        is_consistent = false;
+                    }
+                    last_number = pinned->number;
+
+                    // Keeps an older version pinned across publishes.
+                    if (last_number % 64 == 0) {
+                        held = pinned;
+                    }
+                }
+            });
+        }
+
+        for (int number = 1; number <= version_count; ++number) {
+            holder.Publish(make_shared<const State>(number, live_count));
+        }
+        is_done = true;
+
+        for (auto& reader : readers) {
+            reader.join();
+        }
+
+        ASSERT(is_consistent);
+        ASSERT_EQUAL(holder.Acquire()->number, version_count);
+        ASSERT_EQUAL(live_count.load(), 1);
+    }
+};
+
+}  // namespace test
+}  // namespace trc